@@ -0,0 +1,276 @@
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// JeVois Smart Embedded Machine Vision Toolkit - Copyright (C) 2016 by Laurent Itti, the University of Southern
+// California (USC), and iLab at USC. See http://iLab.usc.edu and http://jevois.org for information about this project.
+//
+// This file is part of the JeVois Smart Embedded Machine Vision Toolkit.  This program is free software; you can
+// redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software
+// Foundation, version 2.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.  You should have received a copy of the GNU General Public License along with this program;
+// if not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// Contact information: Laurent Itti - 3641 Watt Way, HNB-07A - Los Angeles, CA 90089-2520 - USA.
+// Tel: +1 213 740 3527 - itti@pollux.usc.edu - http://iLab.usc.edu - http://jevois.org
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \file */
+
+#include <jevoisbase/src/Components/Saliency/env_alloc.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+
+//! Header stored in front of every block, padded so that user memory keeps the alignment given by the allocator
+union env_alloc_header
+{
+    struct
+    {
+        unsigned long nbytes;            //!< size of the user part of the block
+        struct env_alloc_arena* arena;   //!< arena that the block goes back to when released, or null
+        union env_alloc_header* next;    //!< next block of same size in a free list, only used while cached
+    } h;
+    char pad[32];
+};
+
+//! Number of free lists per arena, threads attached to a slot beyond that share a list with another thread
+#define ENV_ALLOC_NLISTS 8
+
+//! Key of the unused entries of a free list table; no block can be that large since we add a header to it
+#define ENV_ALLOC_NOSIZE (~0UL)
+
+//! Cached released blocks of one given size
+struct env_alloc_cache_entry
+{
+    unsigned long nbytes;
+    union env_alloc_header* head;
+};
+
+//! One set of free lists, in an open-addressing hash table keyed by block size that grows as needed
+struct env_alloc_freelist
+{
+    pthread_mutex_t mutex;
+    struct env_alloc_cache_entry* table; //!< capacity entries, or null if no block was ever cached
+    unsigned long capacity;              //!< always a power of two, or 0
+    unsigned long nsizes;                //!< number of used entries in the table
+};
+
+//! An arena is a set of free lists plus a count of the blocks that its threads got from the allocation function
+struct env_alloc_arena
+{
+    struct env_alloc_freelist lists[ENV_ALLOC_NLISTS];
+    unsigned long count;
+};
+
+// Default allocation functions, wrapped because size_t may not be unsigned long on all platforms:
+static void* env_default_alloc(unsigned long nbytes) { return malloc(nbytes); }
+static void env_default_dealloc(void* mem) { free(mem); }
+
+static pthread_mutex_t g_alloc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static env_alloc_func* g_alloc_func = &env_default_alloc;
+static env_dealloc_func* g_dealloc_func = &env_default_dealloc;
+static unsigned long g_alloc_count = 0;
+
+static __thread struct env_alloc_arena* t_arena = 0;
+static __thread unsigned int t_slot = 0;
+
+// ######################################################################
+// Find the entry for a block size in a free list table, or the unused entry where it should go. Table must not be null
+static struct env_alloc_cache_entry* env_alloc_find(struct env_alloc_freelist* fl, unsigned long nbytes)
+{
+  unsigned long const mask = fl->capacity - 1;
+  unsigned long i = (nbytes * 2654435761UL) & mask;
+  
+  while (fl->table[i].nbytes != nbytes && fl->table[i].nbytes != ENV_ALLOC_NOSIZE) i = (i + 1) & mask;
+  
+  return &fl->table[i];
+}
+
+// ######################################################################
+// Double the capacity of a free list table, keeping its contents. Returns 0 if out of memory. Must hold the lock.
+static int env_alloc_grow(struct env_alloc_freelist* fl)
+{
+  struct env_alloc_cache_entry* const old = fl->table;
+  unsigned long const oldcap = fl->capacity;
+  unsigned long const cap = oldcap ? oldcap * 2 : 32;
+  
+  struct env_alloc_cache_entry* const table =
+    (struct env_alloc_cache_entry*)malloc(cap * sizeof(struct env_alloc_cache_entry));
+  if (table == 0) return 0;
+  
+  for (unsigned long i = 0; i < cap; ++i) { table[i].nbytes = ENV_ALLOC_NOSIZE; table[i].head = 0; }
+  
+  fl->table = table; fl->capacity = cap;
+  for (unsigned long i = 0; i < oldcap; ++i)
+    if (old[i].nbytes != ENV_ALLOC_NOSIZE) *env_alloc_find(fl, old[i].nbytes) = old[i];
+  
+  free(old);
+  return 1;
+}
+
+// ######################################################################
+// Pop a cached block of a given size from a free list, or return null
+static union env_alloc_header* env_alloc_pop(struct env_alloc_freelist* fl, unsigned long nbytes)
+{
+  union env_alloc_header* hdr = 0;
+  
+  pthread_mutex_lock(&fl->mutex);
+  if (fl->table)
+  {
+    struct env_alloc_cache_entry* const e = env_alloc_find(fl, nbytes);
+    hdr = e->head;
+    if (hdr) e->head = hdr->h.next;
+  }
+  pthread_mutex_unlock(&fl->mutex);
+  
+  return hdr;
+}
+
+// ######################################################################
+// Push a released block onto a free list, returns 0 if out of memory (the block is then not cached)
+static int env_alloc_push(struct env_alloc_freelist* fl, union env_alloc_header* hdr)
+{
+  int ok = 1;
+  
+  pthread_mutex_lock(&fl->mutex);
+  
+  // Keep the table at most half full so that probe sequences stay short:
+  if (2 * (fl->nsizes + 1) > fl->capacity) ok = env_alloc_grow(fl);
+  
+  if (ok)
+  {
+    struct env_alloc_cache_entry* const e = env_alloc_find(fl, hdr->h.nbytes);
+    if (e->nbytes == ENV_ALLOC_NOSIZE) { e->nbytes = hdr->h.nbytes; e->head = 0; ++fl->nsizes; }
+    hdr->h.next = e->head;
+    e->head = hdr;
+  }
+  
+  pthread_mutex_unlock(&fl->mutex);
+  
+  return ok;
+}
+
+// ######################################################################
+void* env_allocate(unsigned long nbytes)
+{
+  struct env_alloc_arena* const arena = t_arena;
+  union env_alloc_header* hdr = 0;
+  
+  // Try to recycle a block of the exact same size, first from our own free list and then from those of the other
+  // threads of our arena, since blocks go to the list of whichever thread releases them:
+  if (arena)
+    for (unsigned int k = 0; k < ENV_ALLOC_NLISTS && hdr == 0; ++k)
+      hdr = env_alloc_pop(&arena->lists[(t_slot + k) % ENV_ALLOC_NLISTS], nbytes);
+  
+  if (hdr == 0)
+  {
+    hdr = (union env_alloc_header*)(*g_alloc_func)(nbytes + sizeof(union env_alloc_header));
+    if (hdr == 0) return 0;
+    hdr->h.nbytes = nbytes;
+    hdr->h.arena = arena;
+    
+    __atomic_fetch_add(&g_alloc_count, 1, __ATOMIC_RELAXED);
+    if (arena) __atomic_fetch_add(&arena->count, 1, __ATOMIC_RELAXED);
+  }
+  
+  hdr->h.next = 0;
+  return hdr + 1;
+}
+
+// ######################################################################
+void env_deallocate(void* mem)
+{
+  if (mem == 0) return;
+  
+  union env_alloc_header* hdr = ((union env_alloc_header*)mem) - 1;
+  struct env_alloc_arena* const arena = hdr->h.arena;
+  
+  // Blocks of an arena go to the free list of the releasing thread if it works for that arena, otherwise to slot 0:
+  if (arena && env_alloc_push(&arena->lists[arena == t_arena ? t_slot % ENV_ALLOC_NLISTS : 0], hdr)) return;
+  
+  (*g_dealloc_func)(hdr);
+}
+
+// ######################################################################
+void env_allocation_init(env_alloc_func* alloc_func, env_dealloc_func* dealloc_func)
+{
+  pthread_mutex_lock(&g_alloc_mutex);
+  g_alloc_func = alloc_func ? alloc_func : &env_default_alloc;
+  g_dealloc_func = dealloc_func ? dealloc_func : &env_default_dealloc;
+  pthread_mutex_unlock(&g_alloc_mutex);
+}
+
+// ######################################################################
+struct env_alloc_arena* env_allocation_arena_create(void)
+{
+  struct env_alloc_arena* const arena = (struct env_alloc_arena*)malloc(sizeof(struct env_alloc_arena));
+  if (arena == 0) return 0;
+  
+  for (unsigned int k = 0; k < ENV_ALLOC_NLISTS; ++k)
+  {
+    pthread_mutex_init(&arena->lists[k].mutex, 0);
+    arena->lists[k].table = 0;
+    arena->lists[k].capacity = 0;
+    arena->lists[k].nsizes = 0;
+  }
+  arena->count = 0;
+  
+  return arena;
+}
+
+// ######################################################################
+void env_allocation_arena_flush(struct env_alloc_arena* arena)
+{
+  if (arena == 0) return;
+  
+  for (unsigned int k = 0; k < ENV_ALLOC_NLISTS; ++k)
+  {
+    struct env_alloc_freelist* const fl = &arena->lists[k];
+    
+    // Take the table out under the lock, and free its blocks outside of it:
+    pthread_mutex_lock(&fl->mutex);
+    struct env_alloc_cache_entry* const table = fl->table;
+    unsigned long const cap = fl->capacity;
+    fl->table = 0; fl->capacity = 0; fl->nsizes = 0;
+    pthread_mutex_unlock(&fl->mutex);
+    
+    for (unsigned long i = 0; i < cap; ++i)
+      while (table[i].head)
+      {
+        union env_alloc_header* const hdr = table[i].head;
+        table[i].head = hdr->h.next;
+        (*g_dealloc_func)(hdr);
+      }
+    
+    free(table);
+  }
+}
+
+// ######################################################################
+void env_allocation_arena_destroy(struct env_alloc_arena* arena)
+{
+  if (arena == 0) return;
+  
+  env_allocation_arena_flush(arena);
+  for (unsigned int k = 0; k < ENV_ALLOC_NLISTS; ++k) pthread_mutex_destroy(&arena->lists[k].mutex);
+  free(arena);
+}
+
+// ######################################################################
+void env_allocation_set_thread_arena(struct env_alloc_arena* arena, unsigned int slot)
+{
+  t_arena = arena;
+  t_slot = slot;
+}
+
+// ######################################################################
+struct env_alloc_arena* env_allocation_get_thread_arena(unsigned int* slot)
+{
+  if (slot) *slot = t_slot;
+  return t_arena;
+}
+
+// ######################################################################
+unsigned long env_allocation_count(const struct env_alloc_arena* arena)
+{
+  return __atomic_load_n(arena ? &arena->count : &g_alloc_count, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,82 @@
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// JeVois Smart Embedded Machine Vision Toolkit - Copyright (C) 2016 by Laurent Itti, the University of Southern
+// California (USC), and iLab at USC. See http://iLab.usc.edu and http://jevois.org for information about this project.
+//
+// This file is part of the JeVois Smart Embedded Machine Vision Toolkit.  This program is free software; you can
+// redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software
+// Foundation, version 2.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.  You should have received a copy of the GNU General Public License along with this program;
+// if not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// Contact information: Laurent Itti - 3641 Watt Way, HNB-07A - Los Angeles, CA 90089-2520 - USA.
+// Tel: +1 213 740 3527 - itti@pollux.usc.edu - http://iLab.usc.edu - http://jevois.org
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \file */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+  
+  //! Signature for a custom allocation function
+  typedef void* (env_alloc_func)(unsigned long nbytes);
+  
+  //! Signature for a custom deallocation function
+  typedef void (env_dealloc_func)(void* mem);
+  
+  //! Arena of recycled memory blocks, typically one per Saliency component, see env_allocation_arena_create()
+  struct env_alloc_arena;
+  
+  //! Allocate memory for envision images, pyramids, etc
+  /*! If the calling thread is attached to an arena (see env_allocation_set_thread_arena()), a block of exactly the
+      same size previously released into that arena is recycled if available, otherwise a new block is obtained from
+      the allocation function installed by env_allocation_init() (default is malloc). This function is thread-safe. */
+  void* env_allocate(unsigned long nbytes);
+  
+  //! Release memory that was obtained from env_allocate(); mem may be null
+  /*! Blocks that were allocated while attached to an arena go back to that arena, whichever thread releases them. */
+  void env_deallocate(void* mem);
+  
+  //! Install custom allocation and deallocation functions, or malloc() and free() if null
+  /*! Should only be called when no block obtained from the previous allocation function is still in use. */
+  void env_allocation_init(env_alloc_func* alloc_func, env_dealloc_func* dealloc_func);
+  
+  //! Create an arena that recycles released blocks, keyed by block size
+  /*! Since envision allocates the same set of image sizes for every video frame of a given size, recycling released
+      blocks brings the number of actual heap allocations per frame down to zero once the first few frames have been
+      processed. Released blocks are kept in a few free lists, one per thread slot (see
+      env_allocation_set_thread_arena()), so that threads working for the same arena rarely contend for a lock, and
+      there is no limit on the number of different block sizes. */
+  struct env_alloc_arena* env_allocation_arena_create(void);
+  
+  //! Free all the blocks cached in an arena, and the arena itself
+  /*! No block allocated from the arena may be in use anymore, and no thread may be attached to it anymore. */
+  void env_allocation_arena_destroy(struct env_alloc_arena* arena);
+  
+  //! Free all the blocks that are currently cached in an arena, and forget their sizes
+  /*! Blocks in use are not affected, they will be cached again when released. Other arenas are not affected
+      either. Use this when the image sizes in use change, otherwise the blocks of the old sizes would stay cached
+      until the arena is destroyed. */
+  void env_allocation_arena_flush(struct env_alloc_arena* arena);
+  
+  //! Attach the calling thread to an arena (or detach it if null), using a given free list slot of that arena
+  /*! Threads that allocate concurrently from the same arena should use different slots, e.g., 0 for the thread that
+      calls Saliency::process() and 1, 2, ... for its worker threads. Slots wrap around past the number of free lists
+      of the arena, which is still correct but may then contend for a lock. */
+  void env_allocation_set_thread_arena(struct env_alloc_arena* arena, unsigned int slot);
+  
+  //! Get the arena that the calling thread is attached to (possibly null), and optionally its slot
+  struct env_alloc_arena* env_allocation_get_thread_arena(unsigned int* slot);
+  
+  //! Get the number of blocks obtained so far from the allocation function (i.e., not recycled) for an arena
+  /*! If arena is null, get the total number of blocks obtained so far from the allocation function by all threads,
+      whether attached to an arena or not. */
+  unsigned long env_allocation_count(const struct env_alloc_arena* arena);
+  
+#ifdef __cplusplus
+}
+#endif
@@ -38,6 +38,7 @@
 #include <jevoisbase/src/Components/Saliency/env_c_math_ops.h>
 
 #include <jevoisbase/src/Components/Saliency/env_log.h>
+#include <jevoisbase/src/Components/Saliency/env_simd.h>
 #include <jevoisbase/src/Components/Saliency/env_types.h>
 
 // ######################################################################
@@ -67,7 +68,19 @@ void env_c_lowpass_5_x_dec_x_fewbits_optim(const intg32* src, const env_size_t w
       // skip second point
       
       // rest of the line except last 2 points  [ .^ 4 (8) 4 ] / 16
-      for (env_size_t i = 0; i < w-3; i += 2)
+      env_size_t i = 0;
+#ifdef ENV_SIMD_WIDTH
+      // Vectorized: each iteration produces ENV_SIMD_WIDTH outputs and reads up to src2[2*ENV_SIMD_WIDTH + 2]:
+      for ( ; i + 2 * ENV_SIMD_WIDTH + 2 < w; i += 2 * ENV_SIMD_WIDTH)
+      {
+        env_vec left, center, right, dummy;
+        env_vec_load_deinterleave(src2 + 1, &left, &center);
+        env_vec_load_deinterleave(src2 + 3, &right, &dummy);
+        env_vec_store(dst, env_vec_srai(env_vec_add(env_vec_add(left, right), env_vec_add(center, center)), 2));
+        dst += ENV_SIMD_WIDTH; src2 += 2 * ENV_SIMD_WIDTH;
+      }
+#endif
+      for ( ; i < w-3; i += 2)
       {
         *dst++ = (src2[1] + src2[3] + src2[2] * 2) >> 2;
         src2 += 2;
@@ -111,7 +124,17 @@ void env_c_lowpass_5_y_dec_y_fewbits_optim(const intg32* src, const env_size_t w
     // rest of the column except last 2 points ( [ .^ 4 (8) 4 ] / 16 )T
     for (env_size_t i = 0; i < h-3; i += 2)
     {
-      for (env_size_t k = 0; k < w; ++k)
+      env_size_t k = 0;
+#ifdef ENV_SIMD_WIDTH
+      for ( ; k + ENV_SIMD_WIDTH <= w; k += ENV_SIMD_WIDTH)
+      {
+        const env_vec center = env_vec_load(src + w2);
+        env_vec_store(dst, env_vec_srai(env_vec_add(env_vec_add(env_vec_load(src + w), env_vec_load(src + w3)),
+                                                    env_vec_add(center, center)), 2));
+        dst += ENV_SIMD_WIDTH; src += ENV_SIMD_WIDTH;
+      }
+#endif
+      for ( ; k < w; ++k)
       {
         *dst++ = (src[ w] + src[w3] + src[w2] * 2) >> 2;
         src++;
@@ -121,6 +144,22 @@ void env_c_lowpass_5_y_dec_y_fewbits_optim(const intg32* src, const env_size_t w
   }
 }
 
+// ######################################################################
+void env_c_lowpass_5_y_dec_y_row_fewbits_optim(const intg32* above, const intg32* center, const intg32* below,
+                                               const env_size_t w, intg32* dst)
+{
+  env_size_t k = 0;
+#ifdef ENV_SIMD_WIDTH
+  for ( ; k + ENV_SIMD_WIDTH <= w; k += ENV_SIMD_WIDTH)
+  {
+    const env_vec c = env_vec_load(center + k);
+    env_vec_store(dst + k, env_vec_srai(env_vec_add(env_vec_add(env_vec_load(above + k), env_vec_load(below + k)),
+                                                    env_vec_add(c, c)), 2));
+  }
+#endif
+  for ( ; k < w; ++k) dst[k] = (above[k] + below[k] + center[k] * 2) >> 2;
+}
+
 // ######################################################################
 void env_c_lowpass_9_x_fewbits_optim(const intg32* src, const env_size_t w, const env_size_t h, intg32* dst)
 {
@@ -150,7 +189,19 @@ void env_c_lowpass_9_x_fewbits_optim(const intg32* src, const env_size_t w, cons
        ) / 248;
     
     // far from the borders
-    for (env_size_t i = 0; i < w - 6; ++i)
+    env_size_t i = 0;
+#ifdef ENV_SIMD_WIDTH
+    for ( ; i + ENV_SIMD_WIDTH <= w - 6; i += ENV_SIMD_WIDTH)
+    {
+      env_vec sum = env_vec_mul(env_vec_add(env_vec_load(src), env_vec_load(src + 6)), 8);
+      sum = env_vec_add(sum, env_vec_mul(env_vec_add(env_vec_load(src + 1), env_vec_load(src + 5)), 28));
+      sum = env_vec_add(sum, env_vec_mul(env_vec_add(env_vec_load(src + 2), env_vec_load(src + 4)), 56));
+      sum = env_vec_add(sum, env_vec_mul(env_vec_load(src + 3), 72));
+      env_vec_store(dst, env_vec_srai(sum, 8));
+      dst += ENV_SIMD_WIDTH; src += ENV_SIMD_WIDTH;
+    }
+#endif
+    for ( ; i < w - 6; ++i)
     {
       *dst++ =              // [ 8^ 28 56 (72) 56 28 8 ]
         ((src[0] + src[6]) *  8 +
@@ -188,88 +239,118 @@ void env_c_lowpass_9_x_fewbits_optim(const intg32* src, const env_size_t w, cons
 
 // ######################################################################
 void env_c_lowpass_9_y_fewbits_optim(const intg32* src, const env_size_t w, const env_size_t h, intg32* dst)
+{
+  env_c_lowpass_9_y_rows_fewbits_optim(src, w, h, 0, h, dst);
+}
+
+// ######################################################################
+void env_c_lowpass_9_y_rows_fewbits_optim(const intg32* src, const env_size_t w, const env_size_t h,
+                                          const env_size_t r0, const env_size_t r1, intg32* dst)
 {
   ENV_ASSERT(h >= 9);
+  ENV_ASSERT(r0 <= r1 && r1 <= h);
   
   // index computation speedup:
   const env_size_t w2 = w + w, w3 = w2 + w, w4 = w3 + w, w5 = w4 + w, w6 = w5 + w;
   
+  // src points to input row first:
+  const env_size_t first = (r0 < 3) ? 0 : r0 - 3;
+  
   // *** vertical pass ***
-  for (env_size_t i = 0; i < w; ++i)
-  {
-    *dst++ =
-      (src[ 0] * 72 +
-       src[ w] * 56 +
-       src[w2] * 28 +
-       src[w3] *  8
-       ) / 164;
-    ++src;
-  }
-  src -= w; // back to top-left
-  for (env_size_t i = 0; i < w; ++i)
+  for (env_size_t j = r0; j < r1; ++j)
   {
-    *dst++ =
-      ((src[ 0] + src[w2]) * 56 +
-       src[ w] * 72 +
-       src[w3] * 28 +
-       src[w4] *  8
-       ) / 220;
-    ++src;
-  }
-  src -= w; // back to top-left
-  for (env_size_t i = 0; i < w; ++i)
-  {
-    *dst++ =
-      ((src[ 0] + src[w4]) * 28 +
-       (src[ w] + src[w3]) * 56 +
-       src[w2] * 72 +
-       src[w5] *  8
-       ) / 248;
-    ++src;
-  }
-  src -= w; // back to top-left
-  
-  for (env_size_t j = 0; j < h - 6; j ++)
-    for (env_size_t i = 0; i < w; ++i)
+    if (j < 3)
     {
-      *dst++ =
-        ((src[ 0] + src[w6]) *  8 +
-         (src[ w] + src[w5]) * 28 +
-         (src[w2] + src[w4]) * 56 +
-         src[w3]  * 72
-         ) >> 8;
-      ++src;
+      // topmost points, from input rows 0 and below:
+      const intg32* s = src;
+      switch (j)
+      {
+      case 0:
+        for (env_size_t i = 0; i < w; ++i, ++s)
+          *dst++ =
+            (s[ 0] * 72 +
+             s[ w] * 56 +
+             s[w2] * 28 +
+             s[w3] *  8
+             ) / 164;
+        break;
+        
+      case 1:
+        for (env_size_t i = 0; i < w; ++i, ++s)
+          *dst++ =
+            ((s[ 0] + s[w2]) * 56 +
+             s[ w] * 72 +
+             s[w3] * 28 +
+             s[w4] *  8
+             ) / 220;
+        break;
+        
+      default:
+        for (env_size_t i = 0; i < w; ++i, ++s)
+          *dst++ =
+            ((s[ 0] + s[w4]) * 28 +
+             (s[ w] + s[w3]) * 56 +
+             s[w2] * 72 +
+             s[w5] *  8
+             ) / 248;
+        break;
+      }
+      continue;
     }
-  
-  for (env_size_t i = 0; i < w; ++i)
-  {
-    *dst++ =
-      (src[ 0] *  8 +
-       (src[ w] + src[w5]) * 28 +
-       (src[w2] + src[w4]) * 56 +
-       src[w3] * 72
-       ) / 248;
-    ++src;
-  }
-  for (env_size_t i = 0; i < w; ++i)
-  {
-    *dst++ =
-      (src[ 0] *  8 +
-       src[ w] * 28 +
-       (src[w2] + src[w4]) * 56 +
-       src[w3] * 72
-       ) / 220;
-    ++src;
-  }
-  for (env_size_t i = 0; i < w; ++i)
-  {
-    *dst++ =
-      (src[ 0] *  8 +
-       src[ w] * 28 +
-       src[w2] * 56 +
-       src[w3] * 72
-       ) / 164;
-    ++src;
+    
+    // other points, from input rows j-3 and below:
+    const intg32* s = src + (j - 3 - first) * w;
+    
+    if (j + 3 < h)
+    {
+      // far from the borders
+      env_size_t i = 0;
+#ifdef ENV_SIMD_WIDTH
+      for ( ; i + ENV_SIMD_WIDTH <= w; i += ENV_SIMD_WIDTH)
+      {
+        env_vec sum = env_vec_mul(env_vec_add(env_vec_load(s), env_vec_load(s + w6)), 8);
+        sum = env_vec_add(sum, env_vec_mul(env_vec_add(env_vec_load(s + w), env_vec_load(s + w5)), 28));
+        sum = env_vec_add(sum, env_vec_mul(env_vec_add(env_vec_load(s + w2), env_vec_load(s + w4)), 56));
+        sum = env_vec_add(sum, env_vec_mul(env_vec_load(s + w3), 72));
+        env_vec_store(dst, env_vec_srai(sum, 8));
+        dst += ENV_SIMD_WIDTH; s += ENV_SIMD_WIDTH;
+      }
+#endif
+      for ( ; i < w; ++i)
+      {
+        *dst++ =
+          ((s[ 0] + s[w6]) *  8 +
+           (s[ w] + s[w5]) * 28 +
+           (s[w2] + s[w4]) * 56 +
+           s[w3]  * 72
+           ) >> 8;
+        ++s;
+      }
+    }
+    else if (j + 3 == h)
+      for (env_size_t i = 0; i < w; ++i, ++s)
+        *dst++ =
+          (s[ 0] *  8 +
+           (s[ w] + s[w5]) * 28 +
+           (s[w2] + s[w4]) * 56 +
+           s[w3] * 72
+           ) / 248;
+    else if (j + 2 == h)
+      for (env_size_t i = 0; i < w; ++i, ++s)
+        *dst++ =
+          (s[ 0] *  8 +
+           s[ w] * 28 +
+           (s[w2] + s[w4]) * 56 +
+           s[w3] * 72
+           ) / 220;
+    else
+      for (env_size_t i = 0; i < w; ++i, ++s)
+        *dst++ =
+          (s[ 0] *  8 +
+           s[ w] * 28 +
+           s[w2] * 56 +
+           s[w3] * 72
+           ) / 164;
   }
 }
 
@@ -291,15 +372,58 @@ void env_c_inplace_rectify(intg32* dst, const env_size_t sz)
   for (env_size_t i = 0; i < sz; ++i) if (dst[i] < 0) dst[i] = 0;
 }
 
+// ######################################################################
+void env_c_inplace_rectify_min_max(intg32* dst, const env_size_t sz, intg32* xmini, intg32* xmaxi)
+{
+  ENV_ASSERT(sz > 0);
+  env_size_t i = 0;
+  intg32 mi = dst[0] < 0 ? 0 : dst[0], ma = mi;
+
+#ifdef ENV_SIMD_WIDTH
+  if (sz >= ENV_SIMD_WIDTH)
+  {
+    const env_vec zero = env_vec_set1(0);
+    env_vec vmi = env_vec_set1(mi), vma = vmi;
+    for ( ; i + ENV_SIMD_WIDTH <= sz; i += ENV_SIMD_WIDTH)
+    {
+      const env_vec v = env_vec_max(env_vec_load(dst + i), zero);
+      env_vec_store(dst + i, v);
+      vmi = env_vec_min(vmi, v); vma = env_vec_max(vma, v);
+    }
+    intg32 tmi[ENV_SIMD_WIDTH], tma[ENV_SIMD_WIDTH];
+    env_vec_store(tmi, vmi); env_vec_store(tma, vma);
+    for (env_size_t k = 0; k < ENV_SIMD_WIDTH; ++k) { if (tmi[k] < mi) mi = tmi[k]; if (tma[k] > ma) ma = tma[k]; }
+  }
+#endif
+
+  for ( ; i < sz; ++i)
+  {
+    if (dst[i] < 0) dst[i] = 0;
+    if (dst[i] < mi) mi = dst[i]; else if (dst[i] > ma) ma = dst[i];
+  }
+
+  *xmini = mi; *xmaxi = ma;
+}
+
 // ######################################################################
 void env_c_inplace_normalize(intg32* const dst, const env_size_t sz, const intg32 nmin, const intg32 nmax,
                              intg32* const actualmin_p, intg32* const actualmax_p, const intg32 rangeThresh)
 {
   ENV_ASSERT(sz > 0);
-  ENV_ASSERT(nmax >= nmin);
-  
+
   intg32 mi, ma;
   env_c_get_min_max(dst, sz, &mi, &ma);
+  env_c_inplace_normalize_min_max(dst, sz, mi, ma, nmin, nmax, actualmin_p, actualmax_p, rangeThresh);
+}
+
+// ######################################################################
+void env_c_inplace_normalize_min_max(intg32* const dst, const env_size_t sz, const intg32 mi, const intg32 ma,
+                                     const intg32 nmin, const intg32 nmax, intg32* const actualmin_p,
+                                     intg32* const actualmax_p, const intg32 rangeThresh)
+{
+  ENV_ASSERT(sz > 0);
+  ENV_ASSERT(nmax >= nmin);
+  
   const intg32 old_scale = ma - mi;
   if (old_scale == 0 || old_scale < rangeThresh) // input image is uniform
   { for (env_size_t i = 0; i < sz; ++i) dst[i] = 0; return; }
@@ -371,6 +495,63 @@ void env_c_inplace_normalize(intg32* const dst, const env_size_t sz, const intg3
   if (actualmax_p) *actualmax_p = actualmax;
 }
 
+// ######################################################################
+env_size_t env_c_local_max_sum(const intg32* src, const env_size_t w, const env_size_t h, const intg32 thresh,
+                               intg32* sum_p)
+{
+  intg32 sum = 0;
+  env_size_t num = 0;
+
+  for (env_size_t j = 1; j + 1 < h; ++j)
+  {
+    const intg32* const row = src + j * w;
+    intg32 rowsum = 0;
+    env_size_t i = 1;
+
+#ifdef ENV_SIMD_WIDTH
+    // A value is a local max if it is no smaller than the max of thresh and its 4 neighbors:
+    const env_vec vthresh = env_vec_set1(thresh);
+    env_vec vsum = env_vec_set1(0), vnum = env_vec_set1(0);
+    for ( ; i + ENV_SIMD_WIDTH < w; i += ENV_SIMD_WIDTH)
+    {
+      const env_vec val = env_vec_load(row + i);
+      const env_vec nmax = env_vec_max(env_vec_max(env_vec_load(row + i - w), env_vec_load(row + i + w)),
+                                       env_vec_max(env_vec_load(row + i - 1), env_vec_load(row + i + 1)));
+      const env_vec mask = env_vec_cmpeq(env_vec_max(val, env_vec_max(nmax, vthresh)), val); // -1 or 0
+      vsum = env_vec_add(vsum, env_vec_and(val, mask));
+      vnum = env_vec_sub(vnum, mask);
+    }
+    rowsum = env_vec_hsum(vsum);
+    num += env_vec_hsum(vnum);
+#endif
+
+    for ( ; i + 1 < w; ++i)
+    {
+      const intg32 val = row[i];
+      if (val >= thresh && val >= row[i - w] && val >= row[i + w] && val >= row[i - 1] && val >= row[i + 1])
+      { ++num; rowsum += val; }
+    }
+
+    // Values are non-negative, and a row has few enough of them that rowsum cannot overflow, but the total might:
+    ENV_ASSERT2(INTG32_MAX - rowsum >= sum, "integer overflow");
+    sum += rowsum;
+  }
+
+  *sum_p = sum;
+  return num;
+}
+
+// ######################################################################
+void env_c_inplace_mul_scalar(intg32* const dst, const env_size_t sz, const intg32 val)
+{
+  env_size_t i = 0;
+#ifdef ENV_SIMD_WIDTH
+  for ( ; i + ENV_SIMD_WIDTH <= sz; i += ENV_SIMD_WIDTH)
+    env_vec_store(dst + i, env_vec_mul(env_vec_load(dst + i), val));
+#endif
+  for ( ; i < sz; ++i) dst[i] *= val;
+}
+
 // ######################################################################
 void env_c_luminance_from_byte(const struct env_rgb_pixel* const src, const env_size_t sz,
                                const env_size_t nbits, intg32* const dst)
@@ -398,6 +579,51 @@ void env_c_image_div_scalar_accum(const intg32* const a, const env_size_t sz, in
   for (env_size_t i = 0; i < sz; ++i) dst[i] += a[i] / val;
 }
 
+// ######################################################################
+void env_c_image_div_scalar_sum(const intg32* const* srcs, const env_size_t nsrc, const env_size_t sz, intg32 val,
+                                intg32* const dst)
+{
+  for (env_size_t i = 0; i < sz; ++i)
+  {
+    intg32 sum = 0;
+    for (env_size_t k = 0; k < nsrc; ++k) sum += srcs[k][i] / val;
+    dst[i] = sum;
+  }
+}
+
+// ######################################################################
+void env_c_image_weighted_sum(const intg32* const* srcs, const intg32* weights, const env_size_t nsrc,
+                              const env_size_t sz, const env_size_t shift, intg32* const* weighted, intg32* const dst)
+{
+  env_size_t i = 0;
+
+#ifdef ENV_SIMD_WIDTH
+  for ( ; i + ENV_SIMD_WIDTH <= sz; i += ENV_SIMD_WIDTH)
+  {
+    env_vec sum = env_vec_set1(0);
+    for (env_size_t k = 0; k < nsrc; ++k)
+    {
+      const env_vec v = env_vec_mul(env_vec_sra(env_vec_load(srcs[k] + i), (int)shift), weights[k]);
+      if (weighted[k]) env_vec_store(weighted[k] + i, v);
+      sum = env_vec_add(sum, v);
+    }
+    env_vec_store(dst + i, sum);
+  }
+#endif
+
+  for ( ; i < sz; ++i)
+  {
+    intg32 sum = 0;
+    for (env_size_t k = 0; k < nsrc; ++k)
+    {
+      const intg32 v = (srcs[k][i] >> shift) * weights[k];
+      if (weighted[k]) weighted[k][i] = v;
+      sum += v;
+    }
+    dst[i] = sum;
+  }
+}
+
 // ######################################################################
 void env_c_image_minus_image(const intg32* const a, const intg32* const b, const env_size_t sz, intg32* const dst)
 {
@@ -56,6 +56,13 @@ extern "C"
                                              intg32* dst,
                                              const env_size_t h2);
   
+  /// One interior output row of env_c_lowpass_5_y_dec_y_fewbits_optim(), from 3 consecutive input rows
+  void env_c_lowpass_5_y_dec_y_row_fewbits_optim(const intg32* above,
+                                                 const intg32* center,
+                                                 const intg32* below,
+                                                 const env_size_t w,
+                                                 intg32* dst);
+  
   /// Like env_c_lowpass_9_x_fewbits() but uses optimized filter coefficients
   void env_c_lowpass_9_x_fewbits_optim(const intg32* src,
                                        const env_size_t w,
@@ -68,6 +75,16 @@ extern "C"
                                        const env_size_t h,
                                        intg32* dst);
   
+  /// Output rows [r0, r1) of env_c_lowpass_9_y_fewbits_optim()
+  /** The filter reaches 3 rows above and below each output row, so src points to input row r0-3 (or row 0 if r0 < 3)
+      and should extend to input row r1+2 (or the last row). dst points to output row r0. */
+  void env_c_lowpass_9_y_rows_fewbits_optim(const intg32* src,
+                                            const env_size_t w,
+                                            const env_size_t h,
+                                            const env_size_t r0,
+                                            const env_size_t r1,
+                                            intg32* dst);
+  
   //! Get min and max values
   void env_c_get_min_max(const intg32* src, const env_size_t sz,
                          intg32* mini, intg32* maxi);
@@ -79,6 +96,28 @@ extern "C"
                                const intg32 nmin, const intg32 nmax,
                                intg32* actualmin, intg32* actualmax,
                                intg32 rangeThresh);
+
+  /// Saturate values < 0, and get the min and max of the result, in a single pass
+  void env_c_inplace_rectify_min_max(intg32* dst, const env_size_t sz,
+                                     intg32* mini, intg32* maxi);
+
+  /// Same as env_c_inplace_normalize(), given the current min and max values of dst
+  void env_c_inplace_normalize_min_max(intg32* dst, const env_size_t sz,
+                                       const intg32 mi, const intg32 ma,
+                                       const intg32 nmin, const intg32 nmax,
+                                       intg32* actualmin, intg32* actualmax,
+                                       intg32 rangeThresh);
+
+  /// Get the number and sum of the local maxima of an image that are >= thresh
+  /** A local max is no smaller than any of its 4 neighbors. The 1-pixel border of the image is not considered. Values
+      must be non-negative. */
+  env_size_t env_c_local_max_sum(const intg32* src, const env_size_t w,
+                                 const env_size_t h, const intg32 thresh,
+                                 intg32* sum);
+
+  /// Multiply all values by a scalar, in place
+  void env_c_inplace_mul_scalar(intg32* const dst, const env_size_t sz,
+                                const intg32 val);
   
   /// get the luminance with nbits of precision of the input image
   void env_c_luminance_from_byte(const struct env_rgb_pixel* const src,
@@ -98,6 +137,25 @@ extern "C"
                                     intg32 val,
                                     intg32* const dst);
   
+  /// result = sum over k of srcs[k] / val, computed in a single pass over all images
+  /** Each term is divided separately, so this gives the same result as env_c_image_div_scalar() on the first image
+      followed by env_c_image_div_scalar_accum() on the other ones. */
+  void env_c_image_div_scalar_sum(const intg32* const* srcs,
+                                  const env_size_t nsrc,
+                                  const env_size_t sz,
+                                  intg32 val,
+                                  intg32* const dst);
+
+  /// result = sum over k of (srcs[k] >> shift) * weights[k], in a single pass
+  /** Each weighted term is also stored into weighted[k] unless it is null, weighted[k] may be srcs[k]. */
+  void env_c_image_weighted_sum(const intg32* const* srcs,
+                                const intg32* weights,
+                                const env_size_t nsrc,
+                                const env_size_t sz,
+                                const env_size_t shift,
+                                intg32* const* weighted,
+                                intg32* const dst);
+
   /// result = a - b
   void env_c_image_minus_image(const intg32* const a,
                                const intg32* const b,
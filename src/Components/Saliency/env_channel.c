@@ -38,9 +38,11 @@
 #include <jevoisbase/src/Components/Saliency/env_channel.h>
 
 #include <jevoisbase/src/Components/Saliency/env_c_math_ops.h>
+#include <jevoisbase/src/Components/Saliency/env_gist.h>
 #include <jevoisbase/src/Components/Saliency/env_image_ops.h>
 #include <jevoisbase/src/Components/Saliency/env_log.h>
 #include <jevoisbase/src/Components/Saliency/env_params.h>
+#include <jevoisbase/src/Components/Saliency/env_pyr16.h>
 
 #ifndef ENV_NO_DEBUG
 
@@ -121,15 +123,18 @@ static void abs_diff_thresh_pyr(const struct env_pyr* b, const struct env_pyr* c
 }
 
 // ######################################################################
-void env_chan_process_pyr(const char* tagName, const struct env_dims inputDims, const struct env_pyr* pyr,
-                          const struct env_params* envp, const struct env_math* imath, const int takeAbs,
-                          const int normalizeOutput, struct env_image* result)
+// Shared implementation of env_chan_process_pyr() and env_chan_process_pyr16(); exactly one of pyr and pyr16 is
+// non-null. With pyr16, the submap callbacks receive null center and surround images.
+static void env_chan_process_cs(const char* tagName, const struct env_dims inputDims, const struct env_pyr* pyr,
+                                const struct env_pyr16* pyr16, const struct env_params* envp,
+                                const struct env_math* imath, const int takeAbs, const int normalizeOutput,
+                                struct env_image* result)
 {
   const struct env_dims mapDims =
     { ENV_MAX(inputDims.w / (1 << envp->output_map_level), 1),
       ENV_MAX(inputDims.h / (1 << envp->output_map_level), 1) };
   
-  if (env_pyr_depth(pyr) == 0)
+  if ((pyr ? env_pyr_depth(pyr) : pyr16->depth) == 0)
     // OK, our pyramid wasn't ready to give us any output yet, so just return an empty output image:
   {
     env_img_make_empty(result);
@@ -137,7 +142,7 @@ void env_chan_process_pyr(const char* tagName, const struct env_dims inputDims,
   }
 
   // We only want dyadic pyramids here:
-  ENV_ASSERT(is_dyadic(pyr, envp->cs_lev_min, env_max_pyr_depth(envp)));
+  ENV_ASSERT(pyr16 || is_dyadic(pyr, envp->cs_lev_min, env_max_pyr_depth(envp)));
   
   env_img_resize_dims(result, mapDims);
   
@@ -155,13 +160,22 @@ void env_chan_process_pyr(const char* tagName, const struct env_dims inputDims,
       const env_size_t slev = clev + delta;
       
       // submap is computed from a center-surround difference:
+      const struct env_image* const cimg = pyr ? env_pyr_img(pyr, clev) : 0;
+      const struct env_image* const simg = pyr ? env_pyr_img(pyr, slev) : 0;
       struct env_image submap;
-      env_img_init(&submap, env_pyr_img(pyr, clev)->dims);
-      env_center_surround(env_pyr_img(pyr, clev), env_pyr_img(pyr, slev), takeAbs, &submap);
+      if (pyr)
+      {
+        env_img_init(&submap, cimg->dims);
+        env_center_surround(cimg, simg, takeAbs, &submap);
+      }
+      else
+      {
+        env_img_init(&submap, pyr16->images[clev].dims);
+        env_center_surround16(&pyr16->images[clev], &pyr16->images[slev], takeAbs, pyr16->shift, &submap);
+      }
 
       if (envp->submapPreProc != 0)
-        (*envp->submapPreProc)(tagName, clev, slev, &submap, env_pyr_img(pyr, clev), env_pyr_img(pyr, slev),
-                               envp->user_data_preproc );
+        (*envp->submapPreProc)(tagName, clev, slev, &submap, cimg, simg, envp->user_data_preproc);
       
       // resize submap to fixed scale if necessary:
       if (submap.dims.w > mapDims.w || submap.dims.h > mapDims.h)
@@ -187,8 +201,7 @@ void env_chan_process_pyr(const char* tagName, const struct env_dims inputDims,
       env_max_normalize_inplace(&submap, INTMAXNORMMIN, INTMAXNORMMAX, envp->maxnorm_type, envp->range_thresh);
       
       if (envp->submapPostNormProc != 0)
-        (*envp->submapPostNormProc)(tagName, clev, slev, &submap, env_pyr_img(pyr, clev), env_pyr_img(pyr, slev),
-                                    envp->user_data_postnorm);
+        (*envp->submapPostNormProc)(tagName, clev, slev, &submap, cimg, simg, envp->user_data_postnorm);
       
       // add submap to our sum
       env_c_image_div_scalar_accum(env_img_pixels(&submap), env_img_size(&submap), (intg32) env_max_cs_index(envp),
@@ -204,6 +217,22 @@ void env_chan_process_pyr(const char* tagName, const struct env_dims inputDims,
     env_max_normalize_inplace(result, INTMAXNORMMIN, INTMAXNORMMAX, envp->maxnorm_type, envp->range_thresh);
 }
 
+// ######################################################################
+void env_chan_process_pyr(const char* tagName, const struct env_dims inputDims, const struct env_pyr* pyr,
+                          const struct env_params* envp, const struct env_math* imath, const int takeAbs,
+                          const int normalizeOutput, struct env_image* result)
+{
+  env_chan_process_cs(tagName, inputDims, pyr, 0, envp, imath, takeAbs, normalizeOutput, result);
+}
+
+// ######################################################################
+void env_chan_process_pyr16(const char* tagName, const struct env_dims inputDims, const struct env_pyr16* pyr,
+                            const struct env_params* envp, const struct env_math* imath, const int takeAbs,
+                            const int normalizeOutput, struct env_image* result)
+{
+  env_chan_process_cs(tagName, inputDims, 0, pyr, envp, imath, takeAbs, normalizeOutput, result);
+}
+
 // ######################################################################
 void env_chan_intensity(const char* tagName, const struct env_params* envp, const struct env_math* imath,
                         const struct env_dims inputdims, const struct env_pyr* lowpass5, const int normalizeOutput,
@@ -214,6 +243,49 @@ void env_chan_intensity(const char* tagName, const struct env_params* envp, cons
   if (status_func) (*status_func)(status_userdata, tagName, result);
 }
 
+// ######################################################################
+void env_chan_intensity16(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                          const struct env_dims inputdims, const struct env_pyr16* lowpass5, const int normalizeOutput,
+                          env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
+{
+  env_chan_process_pyr16(tagName, inputdims, lowpass5, envp, imath, 1 /* takeAbs */, normalizeOutput, result);
+
+  if (status_func) (*status_func)(status_userdata, tagName, result);
+}
+
+// ######################################################################
+void env_chan_intensity_img16(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                              const struct env_image* img, const int normalizeOutput,
+                              env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
+{
+  struct env_pyr16 pyr16;
+  env_pyr16_init(&pyr16, env_max_pyr_depth(envp), env_fixed16_shift(imath));
+  env_pyr16_build_lowpass_5(img, 0, envp->cs_lev_min, &pyr16);
+  env_chan_intensity16(tagName, envp, imath, img->dims, &pyr16, normalizeOutput, status_func, status_userdata, result);
+  env_pyr16_make_empty(&pyr16);
+}
+
+// ######################################################################
+// Lowpass pyramid of a full-resolution opponent color map followed by env_chan_intensity()
+static void env_chan_opponent(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                              const struct env_image* img, env_chan_status_func* status_func,
+                              void* status_userdata, struct env_image* result)
+{
+  const env_size_t firstlevel = envp->cs_lev_min;
+  const env_size_t depth = env_max_pyr_depth(envp);
+
+  if (envp->fixed16)
+    env_chan_intensity_img16(tagName, envp, imath, img, 0, status_func, status_userdata, result);
+  else
+  {
+    struct env_pyr pyr;
+    env_pyr_init(&pyr, depth);
+    env_pyr_build_lowpass_5(img, firstlevel, imath, &pyr);
+    env_chan_intensity(tagName, envp, imath, img->dims, &pyr, 0, status_func, status_userdata, result);
+    env_pyr_make_empty(&pyr);
+  }
+}
+
 // ######################################################################
 void env_chan_color(const char* tagName, const struct env_params* envp, const struct env_math* imath,
                     const struct env_rgb_pixel* const colimg,
@@ -226,29 +298,10 @@ void env_chan_color(const char* tagName, const struct env_params* envp, const st
   const intg32 lumthresh = (3*255) / 10;
   env_get_rgby(colimg, dims.w * dims.h, &rg, &by, lumthresh, imath->nbits);
   
-  const env_size_t firstlevel = envp->cs_lev_min;
-  const env_size_t depth = env_max_pyr_depth(envp);
-  
-  {
-    struct env_pyr rgpyr;
-    env_pyr_init(&rgpyr, depth);
-    env_pyr_build_lowpass_5(&rg, firstlevel, imath, &rgpyr);
-    
-    env_chan_intensity("red/green", envp, imath, rg.dims, &rgpyr, 0, status_func, status_userdata, result);
-
-    env_pyr_make_empty(&rgpyr);
-  }
+  env_chan_opponent(env_gist_tags[ENV_GIST_RG], envp, imath, &rg, status_func, status_userdata, result);
 
   struct env_image byOut = env_img_initializer;
-  
-  {
-    struct env_pyr bypyr;
-    env_pyr_init(&bypyr, depth);
-    env_pyr_build_lowpass_5(&by, firstlevel, imath, &bypyr);
-    
-    env_chan_intensity("blue/yellow", envp, imath, by.dims, &bypyr, 0, status_func, status_userdata, &byOut);
-    env_pyr_make_empty(&bypyr);
-  }
+  env_chan_opponent(env_gist_tags[ENV_GIST_BY], envp, imath, &by, status_func, status_userdata, &byOut);
 
   env_img_make_empty(&rg);
   env_img_make_empty(&by);
@@ -273,29 +326,10 @@ void env_chan_color_rgby(const char* tagName, const struct env_params* envp, con
 {
   ENV_ASSERT(env_dims_equal(rg->dims, by->dims));
   
-  const env_size_t firstlevel = envp->cs_lev_min;
-  const env_size_t depth = env_max_pyr_depth(envp);
-  
-  {
-    struct env_pyr rgpyr;
-    env_pyr_init(&rgpyr, depth);
-    env_pyr_build_lowpass_5(rg, firstlevel, imath, &rgpyr);
-    
-    env_chan_intensity("red/green", envp, imath, rg->dims, &rgpyr, 0, status_func, status_userdata, result);
-
-    env_pyr_make_empty(&rgpyr);
-  }
+  env_chan_opponent(env_gist_tags[ENV_GIST_RG], envp, imath, rg, status_func, status_userdata, result);
 
   struct env_image byOut = env_img_initializer;
-  
-  {
-    struct env_pyr bypyr;
-    env_pyr_init(&bypyr, depth);
-    env_pyr_build_lowpass_5(by, firstlevel, imath, &bypyr);
-    
-    env_chan_intensity("blue/yellow", envp, imath, by->dims, &bypyr, 0, status_func, status_userdata, &byOut);
-    env_pyr_make_empty(&bypyr);
-  }
+  env_chan_opponent(env_gist_tags[ENV_GIST_BY], envp, imath, by, status_func, status_userdata, &byOut);
 
   const intg32* const byptr = env_img_pixels(&byOut);
   intg32* const dptr = env_img_pixelsw(result);
@@ -310,19 +344,26 @@ void env_chan_color_rgby(const char* tagName, const struct env_params* envp, con
 }
 
 // ######################################################################
-void env_chan_steerable(const char* tagName, const struct env_params* envp, const struct env_math* imath,
-                        const struct env_dims inputdims, const struct env_pyr* hipass9, const env_size_t thetaidx,
-                        env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
+void env_steerable_coeffs(const struct env_math* imath, const env_size_t thetaidx, intg32* kxnumer, intg32* kynumer)
 {
-  const env_size_t kdenombits = ENV_TRIG_NBITS;
-  
   // spatial_freq = 2.6 / (2*pi) ~= 0.41380285203892792 ~= 2069/5000
   
   const intg32 sfnumer = 2069;
   const intg32 sfdenom = 5000;
   
-  const intg32 kxnumer = ((intg32) (sfnumer * imath->costab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
-  const intg32 kynumer = ((intg32) (sfnumer * imath->sintab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+  *kxnumer = ((intg32) (sfnumer * imath->costab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+  *kynumer = ((intg32) (sfnumer * imath->sintab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+}
+
+// ######################################################################
+void env_chan_steerable(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                        const struct env_dims inputdims, const struct env_pyr* hipass9, const env_size_t thetaidx,
+                        env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
+{
+  const env_size_t kdenombits = ENV_TRIG_NBITS;
+  
+  intg32 kxnumer, kynumer;
+  env_steerable_coeffs(imath, thetaidx, &kxnumer, &kynumer);
   
   // Compute our pyramid:
   struct env_pyr pyr = env_pyr_initializer;
@@ -522,3 +563,70 @@ void env_chan_direction(const char* tagName, const struct env_params* envp, cons
   }
 }
 
+// ######################################################################
+void env_chan_direction_shift(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                              const struct env_dims inputdims, const struct env_pyr* unshiftedPrev,
+                              const struct env_pyr* unshiftedCur, const env_ssize_t dx, const env_ssize_t dy,
+                              env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
+{
+  const env_size_t firstlevel = envp->cs_lev_min;
+  const env_size_t depth = env_max_pyr_depth(envp);
+  
+  const env_size_t nshift = (imath->nbits+1)/2;
+  
+  if (env_pyr_depth(unshiftedPrev) == 0)
+  {
+    // it's our first time, so just return an empty image:
+    env_img_make_empty(result);
+  }
+  else
+  {
+    struct env_pyr pyr;
+    env_pyr_init(&pyr, depth);
+    
+    const intg32 lowthresh = (envp->scale_bits > 8) ? (envp->motion_thresh << (envp->scale_bits - 8))
+      : (envp->motion_thresh >> (8 - envp->scale_bits));
+    
+    // compute the Reichardt maps
+    for (env_size_t i = firstlevel; i < depth; i++)
+    {
+      env_img_resize_dims(env_pyr_imgw(&pyr, i), env_pyr_img(unshiftedCur, i)->dims);
+      
+      const intg32* const ucurr = env_img_pixels(env_pyr_img(unshiftedCur, i));
+      const intg32* const uprev = env_img_pixels(env_pyr_img(unshiftedPrev, i));
+      intg32* const dptr = env_img_pixelsw(env_pyr_imgw(&pyr, i));
+      
+      const env_ssize_t w = (env_ssize_t) env_pyr_img(&pyr, i)->dims.w;
+      const env_ssize_t h = (env_ssize_t) env_pyr_img(&pyr, i)->dims.h;
+      
+      // The shifted value at (x, y) is the unshifted one at (x - dx, y - dy), or zero if that is outside the image, in
+      // which case the Reichardt product is zero too:
+      const env_size_t sz = env_img_size(env_pyr_img(&pyr, i));
+      for (env_size_t c = 0; c < sz; ++c) dptr[c] = 0;
+      
+      const env_ssize_t x0 = ENV_MAX(((env_ssize_t) 0), dx), x1 = ENV_MIN(w, w + dx);
+      const env_ssize_t y0 = ENV_MAX(((env_ssize_t) 0), dy), y1 = ENV_MIN(h, h + dy);
+      
+      for (env_ssize_t y = y0; x0 < x1 && y < y1; ++y)
+      {
+        const env_ssize_t off = x0 + y * w, soff = off - dx - dy * w;
+        const intg32* const uc = ucurr + off; const intg32* const up = uprev + off;
+        const intg32* const sc = ucurr + soff; const intg32* const sp = uprev + soff;
+        intg32* const d = dptr + off;
+        
+        for (env_ssize_t x = 0; x < x1 - x0; ++x)
+        {
+          const intg32 val = ((uc[x] >> nshift) * (sp[x] >> nshift)) - ((up[x] >> nshift) * (sc[x] >> nshift));
+          d[x] = (val < lowthresh) ? 0 : val;
+        }
+      }
+    }
+    
+    env_chan_process_pyr(tagName, inputdims, &pyr, envp, imath, 1 /* takeAbs */, 1 /* normalizeOutput */, result);
+    
+    if (status_func) (*status_func)(status_userdata, tagName, result);
+    
+    env_pyr_make_empty(&pyr);
+  }
+}
+
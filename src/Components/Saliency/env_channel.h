@@ -45,6 +45,7 @@ struct env_image;
 struct env_math;
 struct env_params;
 struct env_pyr;
+struct env_pyr16;
 struct env_rgb_pixel;
 
 #ifdef __cplusplus
@@ -65,7 +66,19 @@ extern "C"
                             const int normalizeOutput,
                             struct env_image* result);
   
+  //! Same as env_chan_process_pyr() but using a 16-bit fixed-point pyramid
+  void env_chan_process_pyr16(const char* tagName,
+                              const struct env_dims inputDims,
+                              const struct env_pyr16* pyr,
+                              const struct env_params* envp,
+                              const struct env_math* imath,
+                              const int takeAbs,
+                              const int normalizeOutput,
+                              struct env_image* result);
+  
   //! An intensity channel.
+  /*! The intg32 pyramid is always used, whether or not envp->fixed16 is set; see env_chan_intensity_img16() for a
+      version that builds a 16-bit fixed-point pyramid directly from the image. */
   void env_chan_intensity(const char* tagName,
                           const struct env_params* envp,
                           const struct env_math* imath,
@@ -76,6 +89,28 @@ extern "C"
                           void* status_userdata,
                           struct env_image* result);
   
+  //! An intensity channel using a 16-bit fixed-point pyramid
+  void env_chan_intensity16(const char* tagName,
+                            const struct env_params* envp,
+                            const struct env_math* imath,
+                            const struct env_dims inputdims,
+                            const struct env_pyr16* lowpass5,
+                            const int normalizeOutput,
+                            env_chan_status_func* status_func,
+                            void* status_userdata,
+                            struct env_image* result);
+  
+  //! An intensity channel using a 16-bit fixed-point lowpass pyramid built directly from a full-resolution image
+  /*! No intg32 pyramid is computed, only the 16-bit levels from envp->cs_lev_min up are kept. */
+  void env_chan_intensity_img16(const char* tagName,
+                                const struct env_params* envp,
+                                const struct env_math* imath,
+                                const struct env_image* img,
+                                const int normalizeOutput,
+                                env_chan_status_func* status_func,
+                                void* status_userdata,
+                                struct env_image* result);
+  
   //! A double opponent color channel that combines r/g, b/y subchannels
   void env_chan_color(const char* tagName,
                       const struct env_params* envp,
@@ -86,6 +121,17 @@ extern "C"
                       void* status_userdata,
                       struct env_image* result);
 
+  //! An intensity channel using a 16-bit fixed-point lowpass pyramid built directly from a full-resolution image
+  /*! No intg32 pyramid is computed, only the 16-bit levels from envp->cs_lev_min up are kept. */
+  void env_chan_intensity_img16(const char* tagName,
+                                const struct env_params* envp,
+                                const struct env_math* imath,
+                                const struct env_image* img,
+                                const int normalizeOutput,
+                                env_chan_status_func* status_func,
+                                void* status_userdata,
+                                struct env_image* result);
+  
   //! A double opponent color channel that combines r/g, b/y subchannels, with direct RG and BY inputs
   void env_chan_color_rgby(const char* tagName,
                            const struct env_params* envp,
@@ -96,6 +142,12 @@ extern "C"
                            void* status_userdata,
                            struct env_image* result);
   
+  //! Get the steerable filter coefficients of orientation thetaidx, for use with kdenombits = ENV_TRIG_NBITS
+  void env_steerable_coeffs(const struct env_math* imath,
+                            const env_size_t thetaidx,
+                            intg32* kxnumer,
+                            intg32* kynumer);
+  
   //! An orientation filtering channel
   void env_chan_steerable(const char* tagName,
                           const struct env_params* envp,
@@ -149,6 +201,22 @@ extern "C"
                           env_chan_status_func* status_func,
                           void* status_userdata,
                           struct env_image* result);
+
+  //! Same as env_chan_direction() for a shift by a whole number of pixels, without shifted pyramids
+  /*! The shifted images are never built: the Reichardt maps are computed directly from the unshifted pyramids, by
+      offsetting the pointers into them by (dx, dy) pixels at each level. Pixels that would come from outside the image
+      are zero, like those of an image shifted by env_shift_image(). */
+  void env_chan_direction_shift(const char* tagName,
+                                const struct env_params* envp,
+                                const struct env_math* imath,
+                                const struct env_dims inputdims,
+                                const struct env_pyr* unshiftedPrev,
+                                const struct env_pyr* unshiftedCur,
+                                const env_ssize_t dx,
+                                const env_ssize_t dy,
+                                env_chan_status_func* status_func,
+                                void* status_userdata,
+                                struct env_image* result);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,82 @@
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// JeVois Smart Embedded Machine Vision Toolkit - Copyright (C) 2016 by Laurent Itti, the University of Southern
+// California (USC), and iLab at USC. See http://iLab.usc.edu and http://jevois.org for information about this project.
+//
+// This file is part of the JeVois Smart Embedded Machine Vision Toolkit.  This program is free software; you can
+// redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software
+// Foundation, version 2.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.  You should have received a copy of the GNU General Public License along with this program;
+// if not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// Contact information: Laurent Itti - 3641 Watt Way, HNB-07A - Los Angeles, CA 90089-2520 - USA.
+// Tel: +1 213 740 3527 - itti@pollux.usc.edu - http://iLab.usc.edu - http://jevois.org
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \file */
+
+#include <jevoisbase/src/Components/Saliency/env_gist.h>
+
+#include <jevoisbase/src/Components/Saliency/env_image_ops.h>
+#include <jevoisbase/src/Components/Saliency/env_log.h>
+
+#include <string.h>
+
+// ######################################################################
+const char env_gist_tags[ENV_GIST_NCHAN][ENV_GIST_TAGLEN] =
+  {
+    "red/green", "blue/yellow", "intensity",
+    "steerable(01/04)", "steerable(02/04)", "steerable(03/04)", "steerable(04/04)",
+    "flicker",
+    "reichardt(01/04)", "reichardt(02/04)", "reichardt(03/04)", "reichardt(04/04)"
+  };
+
+// Number of bits by which the grid averages of each channel are right-shifted to fit in a byte:
+static const unsigned int env_gist_bitshift[ENV_GIST_NCHAN] = { 6, 6, 7, 0, 0, 0, 0, 5, 4, 4, 4, 4 };
+
+// Index of each submap within its channel, as a function of (slev - clev - cs_del_min, clev - cs_lev_min):
+static const env_size_t env_gist_submap_index[2][3] = { { 0, 1, 2 }, { 3, 4, 5 } };
+
+// ######################################################################
+int env_gist_channel(const char* tagName)
+{
+  const char* const first = &env_gist_tags[0][0];
+  const char* const last = &env_gist_tags[ENV_GIST_NCHAN - 1][0];
+
+  // Fast path, tagName is one of our tags:
+  for (int c = 0; c < ENV_GIST_NCHAN; ++c) if (tagName == env_gist_tags[c]) return c;
+
+  // Slow path, tagName is a copy of one of our tags:
+  for (const char* t = first; t <= last; t += ENV_GIST_TAGLEN)
+    if (strcmp(tagName, t) == 0) return (int)((t - first) / ENV_GIST_TAGLEN);
+
+  return -1;
+}
+
+// ######################################################################
+env_size_t env_gist_offset(const int chan, const env_size_t clev, const env_size_t slev,
+                           const struct env_params* envp)
+{
+  ENV_ASSERT(chan >= 0 && chan < ENV_GIST_NCHAN);
+  ENV_ASSERT(clev >= envp->cs_lev_min && clev < envp->cs_lev_min + 3);
+  ENV_ASSERT(slev >= clev + envp->cs_del_min && slev < clev + envp->cs_del_min + 2);
+
+  return (env_size_t)chan * ENV_GIST_CHAN_SIZE +
+    env_gist_submap_index[slev - clev - envp->cs_del_min][clev - envp->cs_lev_min] * ENV_GIST_GRID * ENV_GIST_GRID;
+}
+
+// ######################################################################
+int env_gist_submap(const char* tagName, env_size_t clev, env_size_t slev, struct env_image* submap,
+                    const struct env_image* center, const struct env_image* surround, void* user_data)
+{
+  (void)center; (void)surround;
+  const struct env_gist_data* const gd = (const struct env_gist_data*)user_data;
+
+  const int chan = env_gist_channel(tagName);
+  ENV_ASSERT2(chan >= 0, "Unknown gist channel");
+  if (chan < 0) return 1;
+
+  env_grid_average(submap, gd->gist + env_gist_offset(chan, clev, slev, gd->envp), env_gist_bitshift[chan],
+                   ENV_GIST_GRID, ENV_GIST_GRID);
+  return 0;
+}
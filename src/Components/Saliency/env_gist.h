@@ -0,0 +1,84 @@
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// JeVois Smart Embedded Machine Vision Toolkit - Copyright (C) 2016 by Laurent Itti, the University of Southern
+// California (USC), and iLab at USC. See http://iLab.usc.edu and http://jevois.org for information about this project.
+//
+// This file is part of the JeVois Smart Embedded Machine Vision Toolkit.  This program is free software; you can
+// redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software
+// Foundation, version 2.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.  You should have received a copy of the GNU General Public License along with this program;
+// if not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// Contact information: Laurent Itti - 3641 Watt Way, HNB-07A - Los Angeles, CA 90089-2520 - USA.
+// Tel: +1 213 740 3527 - itti@pollux.usc.edu - http://iLab.usc.edu - http://jevois.org
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \file */
+
+#pragma once
+
+#include <jevoisbase/src/Components/Saliency/env_image.h>
+#include <jevoisbase/src/Components/Saliency/env_params.h>
+
+//! Size of the grid over which each submap is averaged in the gist vector, in each dimension
+#define ENV_GIST_GRID 4
+
+//! Number of submaps per channel in the gist vector: 3 center scales times 2 center-surround deltas
+#define ENV_GIST_MAPS 6
+
+//! Number of gist values per channel
+#define ENV_GIST_CHAN_SIZE (ENV_GIST_MAPS * ENV_GIST_GRID * ENV_GIST_GRID)
+
+//! Max length of a channel tag name, including the terminating null
+#define ENV_GIST_TAGLEN 17
+
+//! Channels of the gist vector, in the order in which they are stored
+enum env_gist_chan
+{
+  ENV_GIST_RG = 0,
+  ENV_GIST_BY,
+  ENV_GIST_INTENSITY,
+  ENV_GIST_ORI0, // 4 orientations
+  ENV_GIST_FLICKER = ENV_GIST_ORI0 + 4,
+  ENV_GIST_MOTION0, // 4 motion directions
+  ENV_GIST_NCHAN = ENV_GIST_MOTION0 + 4
+};
+
+//! Total number of values in the gist vector
+#define ENV_GIST_SIZE (ENV_GIST_NCHAN * ENV_GIST_CHAN_SIZE)
+
+//! Data for env_gist_submap()
+struct env_gist_data
+{
+    unsigned char* gist;  // gist vector of ENV_GIST_SIZE values
+    const struct env_params* envp;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  //! Tag names of all gist channels
+  /*! Channels should be given these exact strings (not copies) as tagName, so that env_gist_channel() can find them
+      with a simple pointer comparison. */
+  extern const char env_gist_tags[ENV_GIST_NCHAN][ENV_GIST_TAGLEN];
+
+  //! Get the gist channel (an env_gist_chan value) of a tag name, or -1 if it is not a gist channel
+  /*! This is immediate if tagName is one of the env_gist_tags, otherwise the tag names are compared. */
+  int env_gist_channel(const char* tagName);
+
+  //! Get the offset in the gist vector of a center-surround submap of a gist channel
+  env_size_t env_gist_offset(const int chan, const env_size_t clev, const env_size_t slev,
+                             const struct env_params* envp);
+
+  //! Compute the gist values of one center-surround submap into the gist vector
+  /*! This has the signature of env_params::submapPreProc, with user_data pointing to a struct env_gist_data. Each
+      submap writes into its own part of the gist vector, so that this may be called concurrently by several channels
+      without any locking. */
+  int env_gist_submap(const char* tagName, env_size_t clev, env_size_t slev, struct env_image* submap,
+                      const struct env_image* center, const struct env_image* surround, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -39,6 +39,7 @@
 
 #include <jevoisbase/src/Components/Saliency/env_c_math_ops.h>
 #include <jevoisbase/src/Components/Saliency/env_log.h>
+#include <jevoisbase/src/Components/Saliency/env_simd.h>
 
 
 // ######################################################################
@@ -317,17 +318,9 @@ void env_lowpass_9(const struct env_image* src, const struct env_math* imath, st
 }
 
 // ######################################################################
-void env_quad_energy(const struct env_image* img1, const struct env_image* img2, struct env_image* result)
+// Quadrature energy of sz pixels, dst may be s1ptr:
+static void quad_energy(const intg32* s1ptr, const intg32* s2ptr, const env_size_t sz, intg32* dptr)
 {
-  ENV_ASSERT(env_dims_equal(img1->dims, img2->dims));
-  ENV_ASSERT(env_dims_equal(img1->dims, result->dims));
-  
-  const intg32* s1ptr = env_img_pixels(img1);
-  const intg32* s2ptr = env_img_pixels(img2);
-  intg32* dptr = env_img_pixelsw(result);
-  
-  const env_size_t sz = env_img_size(img1);
-  
   for (env_size_t i = 0; i < sz; ++i)
   {
     const intg32 s1 = ENV_ABS(s1ptr[i]);
@@ -343,12 +336,56 @@ void env_quad_energy(const struct env_image* img1, const struct env_image* img2,
   }
 }
 
+// ######################################################################
+void env_quad_energy(const struct env_image* img1, const struct env_image* img2, struct env_image* result)
+{
+  ENV_ASSERT(env_dims_equal(img1->dims, img2->dims));
+  ENV_ASSERT(env_dims_equal(img1->dims, result->dims));
+  
+  quad_energy(env_img_pixels(img1), env_img_pixels(img2), env_img_size(img1), env_img_pixelsw(result));
+}
+
+// ######################################################################
+// Complex modulation of one row of the input of a steerable filter, at (x,y) = (-w2l, j) from the image center:
+static void steerable_modulate_row(const intg32* sptr, const env_size_t w, const env_ssize_t w2l, const env_ssize_t j,
+                                   const intg32 kxnumer, const intg32 kynumer, const env_size_t kdenombits,
+                                   const struct env_math* imath, intg32* reptr, intg32* imptr)
+{
+#ifndef ENV_NO_DEBUG
+  const intg32 mdcutoff = INTG32_MAX >> (ENV_TRIG_NBITS+1);
+#endif
+  
+  const env_ssize_t w2r = ((env_ssize_t) w) - w2l;
+  
+  for (env_ssize_t i = -w2l; i < w2r; ++i)
+  {
+    const intg32 arg = (i * kxnumer + j * kynumer) >> kdenombits;
+    
+    env_ssize_t idx = arg % ENV_TRIG_TABSIZ;
+    if (idx < 0) idx += ENV_TRIG_TABSIZ;
+    
+    const intg32 sval = *sptr++;
+    
+    ENV_ASSERT(ENV_ABS(sval) < mdcutoff);
+    
+    *reptr++ = (sval * imath->costab[idx]) >> (ENV_TRIG_NBITS+1);
+    *imptr++ = (sval * imath->sintab[idx]) >> (ENV_TRIG_NBITS+1);
+  }
+}
+
 // ######################################################################
 void env_steerable_filter(const struct env_image* src, const intg32 kxnumer, const intg32 kynumer,
                           const env_size_t kdenombits, const struct env_math* imath, struct env_image* result)
 {
   ENV_ASSERT(env_dims_equal(result->dims, src->dims));
   
+  // Images large enough for our optimized filters are processed tile by tile:
+  if (src->dims.w >= 9 && src->dims.h >= 9)
+  {
+    env_steerable_filter_rows(src, &kxnumer, &kynumer, 1, kdenombits, imath, 0, src->dims.h, &result);
+    return;
+  }
+  
   struct env_image re; env_img_init(&re, src->dims);
   struct env_image im; env_img_init(&im, src->dims);
   const intg32* sptr = env_img_pixels(src);
@@ -368,25 +405,11 @@ void env_steerable_filter(const struct env_image* src, const intg32 kxnumer, con
   
   ENV_ASSERT((2 * ENV_TRIG_NBITS + 1) < 8*sizeof(intg32));
   
-#ifndef ENV_NO_DEBUG
-  const intg32 mdcutoff = INTG32_MAX >> (ENV_TRIG_NBITS+1);
-#endif
-  
   for (env_ssize_t j = -h2l; j < h2r; ++j)
-    for (env_ssize_t i = -w2l; i < w2r; ++i)
-    {
-      const intg32 arg = (i * kxnumer + j * kynumer) >> kdenombits;
-      
-      env_ssize_t idx = arg % ENV_TRIG_TABSIZ;
-      if (idx < 0) idx += ENV_TRIG_TABSIZ;
-      
-      const intg32 sval = *sptr++;
-      
-      ENV_ASSERT(ENV_ABS(sval) < mdcutoff);
-      
-      *reptr++ = (sval * imath->costab[idx]) >> (ENV_TRIG_NBITS+1);
-      *imptr++ = (sval * imath->sintab[idx]) >> (ENV_TRIG_NBITS+1);
-    }
+  {
+    steerable_modulate_row(sptr, src->dims.w, w2l, j, kxnumer, kynumer, kdenombits, imath, reptr, imptr);
+    sptr += src->dims.w; reptr += src->dims.w; imptr += src->dims.w;
+  }
   
   env_lowpass_9(&re, imath, result);
   env_img_swap(&re, result);
@@ -400,12 +423,88 @@ void env_steerable_filter(const struct env_image* src, const intg32 kxnumer, con
   env_img_make_empty(&im);
 }
 
+// ######################################################################
+void env_steerable_filter_rows(const struct env_image* src, const intg32* kxnumer, const intg32* kynumer,
+                               const env_size_t nfilt, const env_size_t kdenombits, const struct env_math* imath,
+                               const env_size_t r0, const env_size_t r1, struct env_image* const* results)
+{
+  const env_size_t w = src->dims.w;
+  const env_size_t h = src->dims.h;
+  
+  ENV_ASSERT(w >= 9 && h >= 9);
+  ENV_ASSERT(r0 <= r1 && r1 <= h);
+  
+  // (x,y) = (0,0) at center of image:
+  const env_ssize_t w2l = ((env_ssize_t) w) / 2;
+  const env_ssize_t w2r = ((env_ssize_t) w) - w2l;
+  const env_ssize_t h2l = ((env_ssize_t) h) / 2;
+  const env_ssize_t h2r = ((env_ssize_t) h) - h2l;
+  
+  // same overflow checks as in env_steerable_filter():
+  for (env_size_t k = 0; k < nfilt; ++k)
+  {
+    ENV_ASSERT(env_dims_equal(results[k]->dims, src->dims));
+    ENV_ASSERT((INTG32_MAX / (ENV_ABS(kxnumer[k]) + ENV_ABS(kynumer[k]))) > (w2r + h2r));
+  }
+  ENV_ASSERT((2 * ENV_TRIG_NBITS + 1) < 8*sizeof(intg32));
+  
+  // Modulated rows, horizontally filtered rows of a tile plus the 3 rows above and below it needed by the vertical
+  // filter, and vertically filtered imaginary part of a tile:
+  const env_size_t tile = ENV_STEERABLE_TILE;
+  const struct env_dims rowdims = { w, 1 }, halodims = { w, tile + 6 }, tiledims = { w, tile };
+  struct env_image re; env_img_init(&re, rowdims);
+  struct env_image im; env_img_init(&im, rowdims);
+  struct env_image hre; env_img_init(&hre, halodims);
+  struct env_image him; env_img_init(&him, halodims);
+  struct env_image vim; env_img_init(&vim, tiledims);
+  
+  for (env_size_t t0 = r0; t0 < r1; t0 += tile)
+  {
+    const env_size_t t1 = ENV_MIN(r1, t0 + tile);
+    const env_size_t a = (t0 < 3) ? 0 : t0 - 3;
+    const env_size_t b = ENV_MIN(h, t1 + 3);
+    
+    // All filters are applied in turn while this tile of the source is in cache:
+    for (env_size_t k = 0; k < nfilt; ++k)
+    {
+      for (env_size_t j = a; j < b; ++j)
+      {
+        steerable_modulate_row(env_img_pixels(src) + j * w, w, w2l, ((env_ssize_t) j) - h2l, kxnumer[k], kynumer[k],
+                               kdenombits, imath, env_img_pixelsw(&re), env_img_pixelsw(&im));
+        env_c_lowpass_9_x_fewbits_optim(env_img_pixels(&re), w, 1, env_img_pixelsw(&hre) + (j - a) * w);
+        env_c_lowpass_9_x_fewbits_optim(env_img_pixels(&im), w, 1, env_img_pixelsw(&him) + (j - a) * w);
+      }
+      
+      // The real part goes directly into the result, which then gets the quadrature energy:
+      intg32* dptr = env_img_pixelsw(results[k]) + t0 * w;
+      env_c_lowpass_9_y_rows_fewbits_optim(env_img_pixels(&hre), w, h, t0, t1, dptr);
+      env_c_lowpass_9_y_rows_fewbits_optim(env_img_pixels(&him), w, h, t0, t1, env_img_pixelsw(&vim));
+      quad_energy(dptr, env_img_pixels(&vim), (t1 - t0) * w, dptr);
+    }
+  }
+  
+  env_img_make_empty(&re);
+  env_img_make_empty(&im);
+  env_img_make_empty(&hre);
+  env_img_make_empty(&him);
+  env_img_make_empty(&vim);
+}
+
 // ######################################################################
 void env_attenuate_borders_inplace(struct env_image* a, env_size_t size)
 {
   ENV_ASSERT(env_img_initialized(a));
   
+  env_attenuate_borders_rows_inplace(a, size, 0, a->dims.h);
+}
+
+// ######################################################################
+void env_attenuate_borders_rows_inplace(struct env_image* a, env_size_t size, const env_size_t r0, const env_size_t r1)
+{
+  ENV_ASSERT(env_img_initialized(a));
+  
   struct env_dims dims = a->dims;
+  ENV_ASSERT(r0 <= r1 && r1 <= dims.h);
   
   if (size * 2 > dims.w) size = dims.w / 2;
   if (size * 2 > dims.h) size = dims.h / 2;
@@ -413,44 +512,31 @@ void env_attenuate_borders_inplace(struct env_image* a, env_size_t size)
   
   const intg32 size_plus_1 = (intg32) (size+1);
   
-  // top lines:
-  intg32 coeff = 1;
-  intg32* aptr = env_img_pixelsw(a);
-  for (env_size_t y = 0; y < size; y ++)
+  for (env_size_t y = r0; y < r1; ++y)
   {
-    for (env_size_t x = 0; x < dims.w; x ++)
+    intg32* aptr = env_img_pixelsw(a) + y * dims.w;
+    
+    // top lines:
+    if (y < size)
     {
-      *aptr = (*aptr / size_plus_1) * coeff;
-      ++aptr;
+      const intg32 coeff = (intg32) (y + 1);
+      for (env_size_t x = 0; x < dims.w; ++x) aptr[x] = (aptr[x] / size_plus_1) * coeff;
     }
-    ++coeff;
-  }
-  // normal lines: start again from beginning to attenuate corners twice:
-  aptr = env_img_pixelsw(a);
-  for (env_size_t y = 0; y < dims.h; y ++)
-  {
-    coeff = 1;
-    for (env_size_t x = 0; x < size; x ++)
+    
+    // left and right columns, which attenuates corners twice:
+    for (env_size_t x = 0; x < size; ++x)
     {
-      *(aptr + dims.w - 1 - x * 2) = (*(aptr + dims.w - 1 - x * 2) / size_plus_1) * coeff;
-      
-      *aptr = (*aptr / size_plus_1) * coeff;
-      ++aptr;
-      ++coeff;
+      const intg32 coeff = (intg32) (x + 1);
+      aptr[dims.w - 1 - x] = (aptr[dims.w - 1 - x] / size_plus_1) * coeff;
+      aptr[x] = (aptr[x] / size_plus_1) * coeff;
     }
-    aptr += dims.w - size;
-  }
-  // bottom lines
-  aptr = env_img_pixelsw(a) + (dims.h - size) * dims.w;
-  coeff = size;
-  for (env_size_t y = dims.h - size; y < dims.h; y ++)
-  {
-    for (env_size_t x = 0; x < dims.w; ++x)
+    
+    // bottom lines:
+    if (y >= dims.h - size)
     {
-      *aptr = (*aptr / size_plus_1) * coeff;
-      ++aptr;
+      const intg32 coeff = (intg32) (dims.h - y);
+      for (env_size_t x = 0; x < dims.w; ++x) aptr[x] = (aptr[x] / size_plus_1) * coeff;
     }
-    --coeff;
   }
 }
 
@@ -501,12 +587,62 @@ void env_pyr_build_hipass_9(const struct env_image* image, env_size_t firstlevel
   env_img_make_empty(&lpfima);
 }
 
+// ######################################################################
+void env_hipass_9_rows(const struct env_image* src, const int decimate, const struct env_math* imath,
+                       const env_size_t r0, const env_size_t r1, struct env_image* lpf, struct env_image* hipass)
+{
+  const env_size_t w = lpf->dims.w;
+  const env_size_t h = lpf->dims.h;
+  
+  ENV_ASSERT(w >= 9 && h >= 9);
+  ENV_ASSERT(r0 <= r1 && r1 <= h);
+  ENV_ASSERT(decimate ? (src->dims.w / 2 == w && src->dims.h / 2 == h) : env_dims_equal(src->dims, lpf->dims));
+  ENV_ASSERT(hipass == 0 || env_dims_equal(hipass->dims, lpf->dims));
+  
+#ifndef ENV_NO_DEBUG
+  const env_size_t filterbits = 8; // log2(256)
+  const env_size_t accumbits = 4; // ceil(log2(9))
+#endif
+  
+  ENV_ASSERT((imath->nbits + filterbits + accumbits + 1) < (8*sizeof(intg32)));
+  
+  // Input rows, plus the 3 rows above and below needed by the vertical filter:
+  const env_size_t a = (r0 < 3) ? 0 : r0 - 3;
+  const env_size_t b = ENV_MIN(h, r1 + 3);
+  const struct env_dims bdims = { w, b - a };
+  
+  struct env_image dec = env_img_initializer;
+  const intg32* inptr = env_img_pixels(src) + a * w;
+  if (decimate)
+  {
+    // same as env_dec_xy(), for our rows only:
+    env_img_init(&dec, bdims);
+    intg32* dptr = env_img_pixelsw(&dec);
+    for (env_size_t j = a; j < b; ++j)
+    {
+      const intg32* sptr = env_img_pixels(src) + 2 * j * src->dims.w;
+      for (env_size_t i = 0; i < w; ++i) *dptr++ = sptr[2 * i];
+    }
+    inptr = env_img_pixels(&dec);
+  }
+  
+  struct env_image tmp; env_img_init(&tmp, bdims);
+  env_c_lowpass_9_x_fewbits_optim(inptr, w, b - a, env_img_pixelsw(&tmp));
+  env_c_lowpass_9_y_rows_fewbits_optim(env_img_pixels(&tmp), w, h, r0, r1, env_img_pixelsw(lpf) + r0 * w);
+  
+  if (hipass)
+    env_c_image_minus_image(inptr + (r0 - a) * w, env_img_pixels(lpf) + r0 * w, (r1 - r0) * w,
+                            env_img_pixelsw(hipass) + r0 * w);
+  
+  env_img_make_empty(&tmp);
+  env_img_make_empty(&dec);
+}
+
 // ######################################################################
 void env_pyr_build_steerable_from_hipass_9(const struct env_pyr* hipass, const intg32 kxnumer, const intg32 kynumer,
                                            const env_size_t kdenombits, const struct env_math* imath,
                                            struct env_pyr* out)
 {
-  const env_size_t attenuation_width = 5;
   const env_size_t depth = env_pyr_depth(hipass);
   
   struct env_pyr result;
@@ -519,16 +655,43 @@ void env_pyr_build_steerable_from_hipass_9(const struct env_pyr* hipass, const i
     
     env_img_resize_dims(env_pyr_imgw(&result, lev), env_pyr_img(hipass, lev)->dims);
     
-    env_steerable_filter(env_pyr_img(hipass, lev), kxnumer, kynumer, kdenombits, imath, env_pyr_imgw(&result, lev));
-
-    // attenuate borders that are overestimated due to filter trunctation:
-    env_attenuate_borders_inplace(env_pyr_imgw(&result, lev), attenuation_width);
+    env_steerable_rows_from_hipass_9(hipass, lev, &kxnumer, &kynumer, 1, kdenombits, imath, 0,
+                                     env_pyr_img(hipass, lev)->dims.h, &result);
   }
   
   env_pyr_swap(out, &result);
   env_pyr_make_empty(&result);
 }
 
+// ######################################################################
+void env_steerable_rows_from_hipass_9(const struct env_pyr* hipass, const env_size_t lev, const intg32* kxnumer,
+                                      const intg32* kynumer, const env_size_t nfilt, const env_size_t kdenombits,
+                                      const struct env_math* imath, const env_size_t r0, const env_size_t r1,
+                                      struct env_pyr* results)
+{
+  const env_size_t attenuation_width = 5;
+  const struct env_image* src = env_pyr_img(hipass, lev);
+  
+  if (src->dims.w >= 9 && src->dims.h >= 9)
+  {
+    struct env_image* outs[ENV_STEERABLE_MAXFILT] = { 0 };
+    ENV_ASSERT(nfilt <= ENV_STEERABLE_MAXFILT);
+    for (env_size_t k = 0; k < nfilt; ++k) outs[k] = env_pyr_imgw(&results[k], lev);
+    
+    env_steerable_filter_rows(src, kxnumer, kynumer, nfilt, kdenombits, imath, r0, r1, outs);
+  }
+  else
+  {
+    // small levels are computed all at once:
+    ENV_ASSERT(r0 == 0 && r1 == src->dims.h);
+    for (env_size_t k = 0; k < nfilt; ++k)
+      env_steerable_filter(src, kxnumer[k], kynumer[k], kdenombits, imath, env_pyr_imgw(&results[k], lev));
+  }
+  
+  // attenuate borders that are overestimated due to filter trunctation:
+  for (env_size_t k = 0; k < nfilt; ++k)
+    env_attenuate_borders_rows_inplace(env_pyr_imgw(&results[k], lev), attenuation_width, r0, r1);
+}
 
 // ######################################################################
 void env_pyr_build_lowpass_5(const struct env_image* image, env_size_t firstlevel, const struct env_math* imath,
@@ -557,6 +720,145 @@ void env_pyr_build_lowpass_5(const struct env_image* image, env_size_t firstleve
   }
 }
 
+// ######################################################################
+void env_pyr_build_lowpass_5_from(env_size_t firstlevel, const struct env_math* imath, struct env_pyr* result)
+{
+  ENV_ASSERT(firstlevel < env_pyr_depth(result));
+  ENV_ASSERT(env_img_initialized(env_pyr_img(result, firstlevel)));
+
+  const env_size_t depth = env_pyr_depth(result);
+
+  for (env_size_t lev = firstlevel + 1; lev < depth; ++lev)
+  {
+    struct env_image tmp1 = env_img_initializer;
+
+    env_lowpass_5_x_dec_x(env_pyr_img(result, lev-1), imath, &tmp1);
+    env_lowpass_5_y_dec_y(&tmp1, imath, env_pyr_imgw(result, lev));
+
+    env_img_make_empty(&tmp1);
+  }
+}
+
+// ######################################################################
+int env_pyr_stream_supported(const struct env_dims dims, const env_size_t nlev)
+{
+  if (nlev == 0 || nlev > ENV_PYR_STREAM_MAXLEV) return 0;
+
+  struct env_dims d = dims;
+  for (env_size_t lev = 0; lev < nlev; ++lev)
+  {
+    if (d.w < 4 || d.h < 4) return 0;
+    d.w /= 2; d.h /= 2;
+  }
+  return 1;
+}
+
+// ######################################################################
+void env_pyr_stream_input_range(const struct env_dims dims, const env_size_t nlev,
+                                const env_size_t row0, const env_size_t row1,
+                                env_size_t* in0, env_size_t* in1)
+{
+  ENV_ASSERT(nlev <= ENV_PYR_STREAM_MAXLEV);
+
+  env_size_t h[ENV_PYR_STREAM_MAXLEV + 1];
+  h[0] = dims.h;
+  for (env_size_t lev = 1; lev <= nlev; ++lev) h[lev] = h[lev-1] / 2;
+
+  // Output row r of a stage needs input rows 2r-1, 2r, 2r+1, except row 0 which needs input rows 0 and 1:
+  env_size_t a = row0, b = row1;
+  for (env_size_t lev = nlev; lev > 0; --lev)
+  {
+    a = (a > 0) ? 2 * a - 1 : 0;
+    b = (2 * b < h[lev-1]) ? 2 * b : h[lev-1];
+  }
+
+  *in0 = a; *in1 = b;
+}
+
+// ######################################################################
+void env_pyr_stream_init(struct env_pyr_stream* s, const struct env_dims dims, const env_size_t nlev,
+                         const env_size_t row0, const env_size_t row1, struct env_image* result)
+{
+  ENV_ASSERT(env_pyr_stream_supported(dims, nlev));
+
+  s->nlev = nlev;
+  s->dims[0] = dims;
+  env_size_t bufsz = 0;
+  for (env_size_t lev = 1; lev <= nlev; ++lev)
+  {
+    s->dims[lev].w = s->dims[lev-1].w / 2; s->dims[lev].h = s->dims[lev-1].h / 2;
+    bufsz += 4 * s->dims[lev].w;
+  }
+
+  ENV_ASSERT(env_dims_equal(result->dims, s->dims[nlev]));
+  ENV_ASSERT(row0 <= row1 && row1 <= s->dims[nlev].h);
+
+  s->row0 = row0; s->row1 = row1; s->result = result;
+  s->buf = (intg32*)env_allocate(bufsz * sizeof(intg32));
+
+  intg32* ptr = s->buf;
+  for (env_size_t lev = 0; lev < nlev; ++lev)
+  {
+    const env_size_t w2 = s->dims[lev+1].w;
+    s->first[lev] = s->dims[lev].h;
+    s->xrows[lev] = ptr; ptr += 3 * w2;
+    s->yrow[lev] = ptr; ptr += w2;
+  }
+}
+
+// ######################################################################
+static void env_pyr_stream_push_level(struct env_pyr_stream* s, const env_size_t lev,
+                                      const intg32* row, const env_size_t j)
+{
+  const env_size_t w2 = s->dims[lev+1].w;
+
+  // Horizontal pass on the new row, into our ring of the last 3 rows:
+  env_c_lowpass_5_x_dec_x_fewbits_optim(row, s->dims[lev].w, 1, s->xrows[lev] + (j % 3) * w2, w2);
+  if (j < s->first[lev]) s->first[lev] = j;
+
+  // Output row r is ready once input row 2r+1 has been received:
+  if ((j & 1) == 0) return;
+  const env_size_t r = j / 2;
+  if (r >= s->dims[lev+1].h) return;
+
+  const int last = (lev + 1 == s->nlev);
+  if (last && (r < s->row0 || r >= s->row1)) return;
+  intg32* const dst = last ? env_img_pixelsw(s->result) + r * w2 : s->yrow[lev];
+
+  if (r == 0)
+  {
+    // topmost points  ( [ (8^) 4 ] / 12 )^T
+    if (s->first[lev] > 0) return;
+    const intg32* const x0 = s->xrows[lev];
+    const intg32* const x1 = x0 + w2;
+    for (env_size_t k = 0; k < w2; ++k) dst[k] = (x0[k] * 2 + x1[k]) / 3;
+  }
+  else
+  {
+    // rest of the column ( [ 4 (8) 4 ] / 16 )^T
+    if (s->first[lev] > j - 2) return;
+    env_c_lowpass_5_y_dec_y_row_fewbits_optim(s->xrows[lev] + ((j - 2) % 3) * w2,
+                                              s->xrows[lev] + ((j - 1) % 3) * w2,
+                                              s->xrows[lev] + (j % 3) * w2, w2, dst);
+  }
+
+  if (!last) env_pyr_stream_push_level(s, lev + 1, dst, r);
+}
+
+// ######################################################################
+void env_pyr_stream_push(struct env_pyr_stream* s, const intg32* row, const env_size_t rowidx)
+{
+  ENV_ASSERT(rowidx < s->dims[0].h);
+  env_pyr_stream_push_level(s, 0, row, rowidx);
+}
+
+// ######################################################################
+void env_pyr_stream_destroy(struct env_pyr_stream* s)
+{
+  env_deallocate(s->buf);
+  s->buf = 0;
+}
+
 // ######################################################################
 void env_downsize_9_inplace(struct env_image* src, const env_size_t depth,
                             const struct env_math* imath)
@@ -688,14 +990,16 @@ void env_max_normalize_std_inplace(struct env_image* src,
 {
   if (!env_img_initialized(src)) return;
   
-  // first clamp negative values to zero
-  env_c_inplace_rectify(env_img_pixelsw(src), env_img_size(src));
+  // first clamp negative values to zero, getting the min and max of the result in the same pass:
+  intg32 smi, sma;
+  env_c_inplace_rectify_min_max(env_img_pixelsw(src), env_img_size(src), &smi, &sma);
   
   // then, normalize between mi and ma if not zero
   intg32 mi = nmi;
   intg32 ma = nma;
   if (nmi != 0 || nma != 0)
-    env_c_inplace_normalize(env_img_pixelsw(src), env_img_size(src), nmi, nma, &mi, &ma, rangeThresh);
+    env_c_inplace_normalize_min_max(env_img_pixelsw(src), env_img_size(src), smi, sma, nmi, nma, &mi, &ma,
+                                    rangeThresh);
   
   const env_size_t w = src->dims.w;
   const env_size_t h = src->dims.h;
@@ -706,26 +1010,8 @@ void env_max_normalize_std_inplace(struct env_image* src,
   const intg32 thresh = mi + (ma - mi) / 10;
   
   // then get the mean value of the local maxima:
-  const intg32* const dptr = env_img_pixels(src);
-  intg32 lm_mean = 0;
-  env_size_t numlm = 0;
-  for (env_size_t j = 1; j+1 < h; ++j)
-    for (env_size_t i = 1; i+1 < w; ++i)
-    {
-      const env_size_t index = i + w * j;
-      const intg32 val = dptr[index];
-      if (val >= thresh &&
-          val >= dptr[index - w] &&
-          val >= dptr[index + w] &&
-          val >= dptr[index - 1] &&
-          val >= dptr[index + 1])  // local max
-      {
-        ++numlm;
-        ENV_ASSERT2(INTG32_MAX - val >= lm_mean,
-                    "integer overflow");
-        lm_mean += val;
-      }
-    }
+  intg32 lm_mean;
+  const env_size_t numlm = env_c_local_max_sum(env_img_pixels(src), w, h, thresh, &lm_mean);
   
   if (numlm > 0) lm_mean /= numlm;
   
@@ -750,13 +1036,7 @@ void env_max_normalize_std_inplace(struct env_image* src,
     /* LERROR("No local maxes found !!"); */
   }
   
-  if (factor != 1)
-  {
-    intg32* const itr = env_img_pixelsw(src);
-    const env_size_t sz = env_img_size(src);
-    for (env_size_t i = 0; i < sz; ++i)
-      itr[i] *= factor;
-  }
+  if (factor != 1) env_c_inplace_mul_scalar(env_img_pixelsw(src), env_img_size(src), factor);
 }
 
 // ######################################################################
@@ -774,43 +1054,62 @@ void env_center_surround(const struct env_image* center, const struct env_image*
   const env_size_t scalex = lw / sw, remx = lw - 1 - (lw % sw);
   const env_size_t scaley = lh / sh, remy = lh - 1 - (lh % sh);
   
-  // scan large image and subtract corresponding pixel from small image:
-  env_size_t ci = 0, cj = 0;
+  // The horizontal stepping through the surround is the same for every row, so we expand each surround row to the
+  // center width once, and then compute the differences on whole rows:
+  intg32* const srow = (intg32*) env_allocate(lw * sizeof(intg32));
+  env_size_t rowstep = 0;
+  {
+    env_size_t ci = 0;
+    for (env_size_t i = 0; i < lw; ++i) if ((++ci) == scalex && i != remx) { ci = 0; ++rowstep; }
+    if (ci) ++rowstep;  // in case the reduction is not round
+  }
+
   const intg32* lptr = env_img_pixels(center);
   const intg32* sptr = env_img_pixels(surround);
+  const intg32* expanded = 0;
   intg32* dptr = env_img_pixelsw(result);
-  
-  if (absol)  // compute abs(hires - lowres):
+  env_size_t cj = 0;
+
+  for (env_size_t j = 0; j < lh; ++j)
   {
-    for (env_size_t j = 0; j < lh; ++j)
+    if (sptr != expanded)
     {
+      const intg32* s = sptr; env_size_t ci = 0;
       for (env_size_t i = 0; i < lw; ++i)
       {
-        if (*lptr > *sptr) *dptr++ = (*lptr++ - *sptr);
-        else *dptr++ = (*sptr - *lptr++);
-        
-        if ((++ci) == scalex && i != remx) { ci = 0; ++sptr; }
+        srow[i] = *s;
+        if ((++ci) == scalex && i != remx) { ci = 0; ++s; }
       }
-      if (ci) { ci = 0; ++sptr; }  // in case the reduction is not round
-      if ((++cj) == scaley && j != remy) cj = 0; else sptr -= sw;
+      expanded = sptr;
     }
-  }
-  else  // compute hires - lowres, clamped to 0:
-  {
-    for (env_size_t j = 0; j < lh; ++j)
-    {
-      for (env_size_t i = 0; i < lw; ++i)
+
+    env_size_t i = 0;
+#ifdef ENV_SIMD_WIDTH
+    if (absol)  // compute abs(hires - lowres):
+      for ( ; i + ENV_SIMD_WIDTH <= lw; i += ENV_SIMD_WIDTH)
       {
-        if (*lptr > *sptr) *dptr++ = (*lptr++ - *sptr);
-        else { *dptr++ = 0; lptr++; }
-        
-        if ((++ci) == scalex && i != remx) { ci = 0; ++sptr; }
+        const env_vec l = env_vec_load(lptr + i), s = env_vec_load(srow + i);
+        env_vec_store(dptr + i, env_vec_sub(env_vec_max(l, s), env_vec_min(l, s)));
+      }
+    else  // compute hires - lowres, clamped to 0:
+      for ( ; i + ENV_SIMD_WIDTH <= lw; i += ENV_SIMD_WIDTH)
+      {
+        const env_vec l = env_vec_load(lptr + i), s = env_vec_load(srow + i);
+        env_vec_store(dptr + i, env_vec_max(env_vec_sub(l, s), env_vec_set1(0)));
       }
-      if (ci) { ci = 0; ++sptr; } // in case the reduction is not round
-      if ((++cj) == scaley && j != remy) cj = 0; else sptr -= sw;
+#endif
+    for ( ; i < lw; ++i)
+    {
+      if (lptr[i] > srow[i]) dptr[i] = lptr[i] - srow[i];
+      else dptr[i] = absol ? srow[i] - lptr[i] : 0;
     }
+
+    lptr += lw; dptr += lw; sptr += rowstep;
+    if ((++cj) == scaley && j != remy) cj = 0; else sptr -= sw;
   }
-  
+
+  env_deallocate(srow);
+
   // attenuate borders:
   env_attenuate_borders_inplace(result, ENV_MAX(result->dims.w, result->dims.h) / 20);
 }
@@ -934,7 +1233,6 @@ void env_grid_average(const struct env_image * src, unsigned char * dest, unsign
   intg32 const * sptr = env_img_pixels(src);
   env_size_t const srcw = src->dims.w; env_size_t const tw = srcw / nx;
   env_size_t const srch = src->dims.h; env_size_t const th = srch / ny;
-  env_size_t const stride = srcw - tw;
   env_size_t const ts = tw * th;
   ENV_ASSERT(tw > 0); ENV_ASSERT(th > 0);
   
@@ -949,11 +1247,24 @@ void env_grid_average(const struct env_image * src, unsigned char * dest, unsign
       intg32 const * pp = p + (srcw * i) / nx;
       
       intg32 sum = 0;
+#ifdef ENV_SIMD_WIDTH
+      // Accumulate whole vectors of each tile row into a vector of partial sums, and the leftovers into sum:
+      env_vec vsum = env_vec_set1(0);
+      for (env_size_t y = 0; y < th; ++y)
+      {
+        env_size_t x = 0;
+        for ( ; x + ENV_SIMD_WIDTH <= tw; x += ENV_SIMD_WIDTH) vsum = env_vec_add(vsum, env_vec_load(pp + x));
+        for ( ; x < tw; ++x) sum += pp[x];
+        pp += srcw;
+      }
+      sum += env_vec_hsum(vsum);
+#else
       for (env_size_t y = 0; y < th; ++y)
       {
-        for (env_size_t x = 0; x < tw; ++x) sum += *pp++;
-        pp += stride;
+        for (env_size_t x = 0; x < tw; ++x) sum += pp[x];
+        pp += srcw;
       }
+#endif
       
       sum /= ts;
       if (sum < 0) sum = 0;
@@ -86,12 +86,44 @@ extern "C"
                             const env_size_t kdenombits,
                             const struct env_math* imath,
                             struct env_image* result);
+
+  //! Number of rows per tile in env_steerable_filter_rows()
+#define ENV_STEERABLE_TILE 32
+
+  //! Compute rows [r0, r1) of env_steerable_filter() for several filters at once
+  /*! The rows are processed in tiles of ENV_STEERABLE_TILE rows, and all filters are applied to each tile before
+      moving on to the next one. Each results[k] must already have the dims of src, which must be at least 9x9. Rows
+      outside [r0, r1) are not touched, so that several threads can compute different rows of the same results. */
+  void env_steerable_filter_rows(const struct env_image* src,
+                                 const intg32* kxnumer, const intg32* kynumer,
+                                 const env_size_t nfilt,
+                                 const env_size_t kdenombits,
+                                 const struct env_math* imath,
+                                 const env_size_t r0, const env_size_t r1,
+                                 struct env_image* const* results);
+
   void env_attenuate_borders_inplace(struct env_image* a, env_size_t size);
+
+  //! Same as env_attenuate_borders_inplace() but only on rows [r0, r1)
+  void env_attenuate_borders_rows_inplace(struct env_image* a, env_size_t size,
+                                          const env_size_t r0, const env_size_t r1);
   
   void env_pyr_build_hipass_9(const struct env_image* image,
                               env_size_t firstlevel,
                               const struct env_math* imath,
                               struct env_pyr* result);
+
+  //! Compute rows [r0, r1) of one level of env_pyr_build_hipass_9()
+  /*! src is the lowpass image of the previous level, which gets decimated, or the input image of level 0 if decimate
+      is 0. The rows of the lowpass image of this level go into lpf, and those of the hipass image into hipass unless
+      it is null. Both must already have the dims of the level, which must be at least 9x9. Rows outside [r0, r1)
+      are not touched, so that several threads can compute different rows of the same level. */
+  void env_hipass_9_rows(const struct env_image* src,
+                         const int decimate,
+                         const struct env_math* imath,
+                         const env_size_t r0, const env_size_t r1,
+                         struct env_image* lpf,
+                         struct env_image* hipass);
   
   void env_pyr_build_steerable_from_hipass_9(const struct env_pyr* hipass,
                                              const intg32 kxnumer,
@@ -99,6 +131,23 @@ extern "C"
                                              const env_size_t kdenombits,
                                              const struct env_math* imath,
                                              struct env_pyr* result);
+
+  //! Max number of filters in env_steerable_rows_from_hipass_9()
+#define ENV_STEERABLE_MAXFILT 16
+
+  //! Compute rows [r0, r1) of level lev of env_pyr_build_steerable_from_hipass_9() for several filters at once
+  /*! Level lev of each of the nfilt results must already have the dims of that hipass level. Levels smaller than 9x9
+      must be computed all at once, other ones may be split into several row ranges computed by different threads. */
+  void env_steerable_rows_from_hipass_9(const struct env_pyr* hipass,
+                                        const env_size_t lev,
+                                        const intg32* kxnumer,
+                                        const intg32* kynumer,
+                                        const env_size_t nfilt,
+                                        const env_size_t kdenombits,
+                                        const struct env_math* imath,
+                                        const env_size_t r0, const env_size_t r1,
+                                        struct env_pyr* results);
+
   //! Wrapper for _cpu or _cuda version
   void env_pyr_build_lowpass_5(const struct env_image* image,
                                env_size_t firstlevel,
@@ -110,7 +159,52 @@ extern "C"
                                          env_size_t firstlevel,
                                    const struct env_math* imath,
                                    struct env_pyr* result);
-  
+
+  //! Complete a lowpass-5 pyramid whose level firstlevel has already been computed
+  /*! Levels above firstlevel are computed from it exactly as env_pyr_build_lowpass_5() would have. */
+  void env_pyr_build_lowpass_5_from(env_size_t firstlevel, const struct env_math* imath, struct env_pyr* result);
+
+  //! Maximum number of decimation stages in an env_pyr_stream
+#define ENV_PYR_STREAM_MAXLEV 8
+
+  //! Row-streaming computation of one level of a lowpass-5 pyramid
+  /*! Rows of a level-0 image are pushed one at a time and in order, possibly starting anywhere in the image. Each row
+      goes through the successive x and y filter/decimation stages as soon as enough rows are available, such that
+      level nlev is computed while only ever keeping 3 filtered rows per stage in memory. Rows [row0, row1) of level
+      nlev are written into the result image, which must have been allocated with the level nlev dims by the caller.
+      Results are bit-exact with env_pyr_build_lowpass_5(). Using several streams on disjoint row ranges of the same
+      result image allows parallel computation, see env_pyr_stream_input_range(). */
+  struct env_pyr_stream
+  {
+      env_size_t nlev; //!< Number of decimation stages; we compute level nlev
+      struct env_dims dims[ENV_PYR_STREAM_MAXLEV + 1]; //!< Dims of each level
+      env_size_t first[ENV_PYR_STREAM_MAXLEV]; //!< First row received by each stage, or h if none yet
+      intg32* xrows[ENV_PYR_STREAM_MAXLEV]; //!< Ring of 3 x-filtered rows for each stage
+      intg32* yrow[ENV_PYR_STREAM_MAXLEV]; //!< Output row of each stage
+      env_size_t row0, row1; //!< Range of rows of level nlev to write into result
+      struct env_image* result; //!< Destination image for level nlev
+      intg32* buf; //!< Memory backing xrows and yrow
+  };
+
+  //! Check whether a stream can be used to compute level nlev from an image of given dims
+  /*! Streams only handle the general case of the filters, which requires all levels below nlev to be at least 4x4. */
+  int env_pyr_stream_supported(const struct env_dims dims, const env_size_t nlev);
+
+  //! Get the range [*in0, *in1) of level-0 rows that must be pushed to compute rows [row0, row1) of level nlev
+  void env_pyr_stream_input_range(const struct env_dims dims, const env_size_t nlev,
+                                  const env_size_t row0, const env_size_t row1,
+                                  env_size_t* in0, env_size_t* in1);
+
+  //! Initialize a stream that will write rows [row0, row1) of level nlev into result
+  void env_pyr_stream_init(struct env_pyr_stream* s, const struct env_dims dims, const env_size_t nlev,
+                           const env_size_t row0, const env_size_t row1, struct env_image* result);
+
+  //! Push row number rowidx of the level-0 image into the stream
+  void env_pyr_stream_push(struct env_pyr_stream* s, const intg32* row, const env_size_t rowidx);
+
+  //! Free the memory held by a stream
+  void env_pyr_stream_destroy(struct env_pyr_stream* s);
+
   void env_downsize_9_inplace(struct env_image* src, const env_size_t depth,
                               const struct env_math* imath);
   void env_rescale(const struct env_image* src, struct env_image* result);
@@ -67,6 +67,23 @@ void env_motion_channel_destroy(struct env_motion_channel* chan)
   chan->shifted_prev = 0;
 }
 
+// ######################################################################
+int env_motion_direction_shift(const struct env_math* imath, const env_size_t dir, const env_size_t num_directions,
+                               env_ssize_t* dx, env_ssize_t* dy)
+{
+  // theta = (360.0 * dir) / num_directions, as in env_motion_channel_input_and_consume_pyr():
+  const env_size_t thetaidx = (dir * ENV_TRIG_TABSIZ) / num_directions;
+  ENV_ASSERT(thetaidx < ENV_TRIG_TABSIZ);
+  
+  const env_ssize_t dxnumer = imath->costab[thetaidx], dynumer = -imath->sintab[thetaidx];
+  const env_ssize_t denom = (1 << ENV_TRIG_NBITS);
+  
+  if (dxnumer % denom != 0 || dynumer % denom != 0) return 0;
+  
+  *dx = dxnumer / denom; *dy = dynumer / denom;
+  return 1;
+}
+
 // ######################################################################
 void env_motion_channel_input_and_consume_pyr(struct env_motion_channel* chan,
                                               const char* tagName,
@@ -116,24 +133,32 @@ void env_motion_channel_input_and_consume_pyr(struct env_motion_channel* chan,
     buf[10] = '0' + ((dir+1) / 10);
     buf[11] = '0' + ((dir+1) % 10);
     
-    // create an empty pyramid
-    struct env_pyr shiftedCur;
-    env_pyr_init(&shiftedCur, depth);
-    
-    // fill the empty pyramid with the shifted version
-    for (env_size_t i = firstlevel; i < depth; ++i)
+    env_ssize_t dx, dy;
+    if (env_motion_direction_shift(imath, dir, chan->num_directions, &dx, &dy))
+      // no need for shifted pyramids, just use pointer offsets into the unshifted ones:
+      env_chan_direction_shift(buf, envp, imath, inputdims, &chan->unshifted_prev, unshiftedCur, dx, dy,
+                               status_func, status_userdata, &chanOut);
+    else
     {
-      env_img_resize_dims(env_pyr_imgw(&shiftedCur, i), env_pyr_img(unshiftedCur, i)->dims);
-      env_shift_image(env_pyr_img(unshiftedCur, i), imath->costab[thetaidx], -imath->sintab[thetaidx],
-                      ENV_TRIG_NBITS, env_pyr_imgw(&shiftedCur, i));
+      // create an empty pyramid
+      struct env_pyr shiftedCur;
+      env_pyr_init(&shiftedCur, depth);
+      
+      // fill the empty pyramid with the shifted version
+      for (env_size_t i = firstlevel; i < depth; ++i)
+      {
+        env_img_resize_dims(env_pyr_imgw(&shiftedCur, i), env_pyr_img(unshiftedCur, i)->dims);
+        env_shift_image(env_pyr_img(unshiftedCur, i), imath->costab[thetaidx], -imath->sintab[thetaidx],
+                        ENV_TRIG_NBITS, env_pyr_imgw(&shiftedCur, i));
+      }
+      
+      env_chan_direction(buf, envp, imath, inputdims, &chan->unshifted_prev, unshiftedCur,
+                         &chan->shifted_prev[dir], &shiftedCur, status_func, status_userdata, &chanOut);
+      
+      env_pyr_swap(&chan->shifted_prev[dir], &shiftedCur);
+      env_pyr_make_empty(&shiftedCur);
     }
     
-    env_chan_direction(buf, envp, imath, inputdims, &chan->unshifted_prev, unshiftedCur,
-                       &chan->shifted_prev[dir], &shiftedCur, status_func, status_userdata, &chanOut);
-    
-    env_pyr_swap(&chan->shifted_prev[dir], &shiftedCur);
-    env_pyr_make_empty(&shiftedCur);
-    
     if (env_img_initialized(&chanOut))
     {
       if (!env_img_initialized(result))
@@ -66,6 +66,13 @@ extern "C"
   
   void env_motion_channel_destroy(struct env_motion_channel* chan);
   
+  /// Get the shift of one motion direction, in pixels, if it is a whole number of pixels
+  /** Returns 1 and sets dx and dy if both components of the shift that env_shift_image() would apply for the
+      Reichardt detector of this direction are whole numbers of pixels, or returns 0 otherwise. With the default 4
+      directions, all shifts are by one pixel along the x or y axis. */
+  int env_motion_direction_shift(const struct env_math* imath, const env_size_t dir, const env_size_t num_directions,
+                                 env_ssize_t* dx, env_ssize_t* dy);
+  
   /// env_motion_channel only requires luminosity input
   /** for efficiency, the motion channel takes ownership of the lowpass5 pyramid (rather than needing to make a copy of
       it), so that after this function the lowpass5 argument will point to an empty pyramid */
@@ -49,6 +49,7 @@ void env_params_set_defaults(struct env_params* envp)
   envp->motion_thresh = 0;
   envp->flicker_thresh = 0;
   envp->multiscale_flicker = 0;
+  envp->fixed16 = 0;
   envp->num_orientations = 4;
   envp->cs_lev_min = 2;
   envp->cs_lev_max = 4;
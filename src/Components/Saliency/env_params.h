@@ -50,6 +50,7 @@ struct env_params
     byte motion_thresh;
     byte flicker_thresh;
     byte multiscale_flicker;
+    byte fixed16;  //!< use 16-bit fixed-point pyramids for the intensity and color channels (see env_pyr16.h)
     env_size_t num_orientations;  //!< number of Gabor subchannels
     env_size_t cs_lev_min;
     env_size_t cs_lev_max;
@@ -0,0 +1,284 @@
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// JeVois Smart Embedded Machine Vision Toolkit - Copyright (C) 2016 by Laurent Itti, the University of Southern
+// California (USC), and iLab at USC. See http://iLab.usc.edu and http://jevois.org for information about this project.
+//
+// This file is part of the JeVois Smart Embedded Machine Vision Toolkit.  This program is free software; you can
+// redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software
+// Foundation, version 2.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.  You should have received a copy of the GNU General Public License along with this program;
+// if not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// Contact information: Laurent Itti - 3641 Watt Way, HNB-07A - Los Angeles, CA 90089-2520 - USA.
+// Tel: +1 213 740 3527 - itti@pollux.usc.edu - http://iLab.usc.edu - http://jevois.org
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \file */
+
+#include <jevoisbase/src/Components/Saliency/env_pyr16.h>
+
+#include <jevoisbase/src/Components/Saliency/env_image_ops.h>
+#include <jevoisbase/src/Components/Saliency/env_log.h>
+#include <jevoisbase/src/Components/Saliency/env_simd.h>
+
+// Note: all values are within [-ENV_FIXED16_MAX, ENV_FIXED16_MAX], so that sums of up to 4 of them, as computed by
+// the lowpass filters below, and differences of 2 of them, as computed by the center-surround, always fit in 16 bits.
+// Hence SIMD and scalar code give identical results without the need for saturating arithmetic.
+
+// ######################################################################
+void env_img16_resize_dims(struct env_image16* img, const struct env_dims d)
+{
+  if (d.w != img->dims.w || d.h != img->dims.h)
+  {
+    env_deallocate(img->pixels);
+    img->pixels = (intg16*) env_allocate(d.w * d.h * sizeof(intg16));
+    img->dims = d;
+  }
+}
+
+// ######################################################################
+void env_img16_make_empty(struct env_image16* img)
+{
+  env_deallocate(img->pixels);
+  img->dims.w = img->dims.h = 0;
+  img->pixels = 0;
+}
+
+// ######################################################################
+void env_img16_pack(const struct env_image* src, const env_size_t shift, struct env_image16* dst)
+{
+  env_img16_resize_dims(dst, src->dims);
+
+  const intg32* sptr = env_img_pixels(src);
+  intg16* dptr = dst->pixels;
+  const env_size_t sz = env_img_size(src);
+
+  env_size_t i = 0;
+#ifdef ENV_SIMD16_WIDTH
+  const env_vec16 lo = env_vec16_set1(-ENV_FIXED16_MAX), hi = env_vec16_set1(ENV_FIXED16_MAX);
+  for ( ; i + ENV_SIMD16_WIDTH <= sz; i += ENV_SIMD16_WIDTH)
+    env_vec16_store(dptr + i, env_vec16_min(env_vec16_max(env_vec16_load_narrow(sptr + i, (int)shift), lo), hi));
+#endif
+  for ( ; i < sz; ++i)
+  {
+    const intg32 v = sptr[i] >> shift;
+    dptr[i] = (intg16)(v > ENV_FIXED16_MAX ? ENV_FIXED16_MAX : (v < -ENV_FIXED16_MAX ? -ENV_FIXED16_MAX : v));
+  }
+}
+
+// ######################################################################
+void env_pyr16_init(struct env_pyr16* pyr, const env_size_t depth, const env_size_t shift)
+{
+  pyr->images = (struct env_image16*)env_allocate(depth * sizeof(struct env_image16));
+  pyr->depth = depth;
+  pyr->shift = shift;
+
+  for (env_size_t i = 0; i < depth; ++i)
+  { pyr->images[i].dims.w = pyr->images[i].dims.h = 0; pyr->images[i].pixels = 0; }
+}
+
+// ######################################################################
+void env_pyr16_make_empty(struct env_pyr16* pyr)
+{
+  for (env_size_t i = 0; i < pyr->depth; ++i) env_img16_make_empty(&pyr->images[i]);
+  env_deallocate(pyr->images);
+  pyr->images = 0;
+  pyr->depth = 0;
+}
+
+// ######################################################################
+// Anderson's separable kernel: 1/16 * [1 4 6 4 1], same as env_c_lowpass_5_x_dec_x_fewbits_optim()
+static void env_img16_lowpass_5_x_dec_x(const struct env_image16* src, struct env_image16* result)
+{
+  const env_size_t w = src->dims.w, h = src->dims.h;
+  const struct env_dims dims2 = { w < 2 ? w : w / 2, h };
+  env_img16_resize_dims(result, dims2);
+
+  const intg16* sptr = src->pixels;
+  intg16* dptr = result->pixels;
+
+  if (w < 2) // nothing to smooth
+  {
+    for (env_size_t i = 0; i < w * h; ++i) dptr[i] = sptr[i];
+    return;
+  }
+
+  if (w == 2 || w == 3)
+    for (env_size_t j = 0; j < h; ++j)
+    {
+      // leftmost point  [ (6^) 4 ] / 10
+      *dptr++ = (intg16)((sptr[0] * 3 + sptr[1] * 2) / 5);
+      sptr += w;
+    }
+  else
+    for (env_size_t j = 0; j < h; ++j)
+    {
+      const intg16* src2 = sptr;
+      // leftmost point  [ (8^) 4 ] / 12
+      *dptr++ = (intg16)((src2[0] * 2 + src2[1]) / 3);
+
+      // rest of the line except last 2 points  [ .^ 4 (8) 4 ] / 16
+      env_size_t i = 0;
+#ifdef ENV_SIMD16_WIDTH
+      for ( ; i + 2 * ENV_SIMD16_WIDTH + 2 < w; i += 2 * ENV_SIMD16_WIDTH)
+      {
+        env_vec16 left, center, right, dummy;
+        env_vec16_load_deinterleave(src2 + 1, &left, &center);
+        env_vec16_load_deinterleave(src2 + 3, &right, &dummy);
+        env_vec16_store(dptr, env_vec16_srai(env_vec16_add(env_vec16_add(left, right),
+                                                           env_vec16_add(center, center)), 2));
+        dptr += ENV_SIMD16_WIDTH; src2 += 2 * ENV_SIMD16_WIDTH;
+      }
+#endif
+      for ( ; i < w-3; i += 2)
+      {
+        *dptr++ = (intg16)((src2[1] + src2[3] + src2[2] * 2) >> 2);
+        src2 += 2;
+      }
+
+      sptr += w;
+    }
+}
+
+// ######################################################################
+// Anderson's separable kernel: 1/16 * [1 4 6 4 1], same as env_c_lowpass_5_y_dec_y_fewbits_optim()
+static void env_img16_lowpass_5_y_dec_y(const struct env_image16* src, struct env_image16* result)
+{
+  const env_size_t w = src->dims.w, h = src->dims.h;
+  const struct env_dims dims2 = { w, h < 2 ? h : h / 2 };
+  env_img16_resize_dims(result, dims2);
+
+  const intg16* sptr = src->pixels;
+  intg16* dptr = result->pixels;
+
+  if (h < 2) // nothing to smooth
+  {
+    for (env_size_t i = 0; i < w * h; ++i) dptr[i] = sptr[i];
+    return;
+  }
+
+  const env_size_t w2 = w + w, w3 = w2 + w;
+
+  if (h == 2 || h == 3)
+  {
+    // topmost points  ( [ (6^) 4 ] / 10 )^T
+    for (env_size_t k = 0; k < w; ++k) dptr[k] = (intg16)((sptr[k] * 3 + sptr[k + w] * 2) / 5);
+    return;
+  }
+
+  // topmost points  ( [ (8^) 4 ] / 12 )^T
+  for (env_size_t k = 0; k < w; ++k) *dptr++ = (intg16)((sptr[k] * 2 + sptr[k + w]) / 3);
+
+  // rest of the column except last 2 points ( [ .^ 4 (8) 4 ] / 16 )T
+  for (env_size_t i = 0; i < h-3; i += 2)
+  {
+    env_size_t k = 0;
+#ifdef ENV_SIMD16_WIDTH
+    for ( ; k + ENV_SIMD16_WIDTH <= w; k += ENV_SIMD16_WIDTH)
+    {
+      const env_vec16 center = env_vec16_load(sptr + w2);
+      env_vec16_store(dptr, env_vec16_srai(env_vec16_add(env_vec16_add(env_vec16_load(sptr + w),
+                                                                        env_vec16_load(sptr + w3)),
+                                                         env_vec16_add(center, center)), 2));
+      dptr += ENV_SIMD16_WIDTH; sptr += ENV_SIMD16_WIDTH;
+    }
+#endif
+    for ( ; k < w; ++k)
+    {
+      *dptr++ = (intg16)((sptr[w] + sptr[w3] + sptr[w2] * 2) >> 2);
+      sptr++;
+    }
+    sptr += w;
+  }
+}
+
+// ######################################################################
+void env_pyr16_build_lowpass_5(const struct env_image* image, const env_size_t imglev, const env_size_t firstlevel,
+                               struct env_pyr16* result)
+{
+  ENV_ASSERT(env_img_initialized(image));
+  ENV_ASSERT(imglev < result->depth);
+
+  env_img16_pack(image, result->shift, &result->images[imglev]);
+
+  for (env_size_t lev = imglev + 1; lev < result->depth; ++lev)
+  {
+    struct env_image16 tmp1 = { { 0, 0 }, 0 };
+
+    env_img16_lowpass_5_x_dec_x(&result->images[lev-1], &tmp1);
+    env_img16_lowpass_5_y_dec_y(&tmp1, &result->images[lev]);
+
+    if ((lev - 1) < firstlevel) env_img16_make_empty(&result->images[lev-1]);
+
+    env_img16_make_empty(&tmp1);
+  }
+}
+
+// ######################################################################
+void env_center_surround16(const struct env_image16* center, const struct env_image16* surround,
+                           const int absol, const env_size_t shift, struct env_image* result)
+{
+  // result has the size of the larger image:
+  ENV_ASSERT(env_dims_equal(result->dims, center->dims));
+
+  const env_size_t lw = center->dims.w, lh = center->dims.h;
+  const env_size_t sw = surround->dims.w, sh = surround->dims.h;
+
+  ENV_ASSERT2(lw >= sw && lh >= sh, "center must be larger than surround");
+
+  const env_size_t scalex = lw / sw, remx = lw - 1 - (lw % sw);
+  const env_size_t scaley = lh / sh, remy = lh - 1 - (lh % sh);
+
+  // We step through the surround exactly as env_center_surround() does. The horizontal stepping is the same for every
+  // row, so we expand each surround row to the center width once, and then compute the differences on whole rows:
+  intg16* const srow = (intg16*) env_allocate(lw * sizeof(intg16));
+  env_size_t rowstep = 0;
+  {
+    env_size_t ci = 0;
+    for (env_size_t i = 0; i < lw; ++i) if ((++ci) == scalex && i != remx) { ci = 0; ++rowstep; }
+    if (ci) ++rowstep;  // in case the reduction is not round
+  }
+
+  const intg16* lptr = center->pixels;
+  const intg16* sptr = surround->pixels;
+  const intg16* expanded = 0;
+  intg32* dptr = env_img_pixelsw(result);
+  env_size_t cj = 0;
+
+  for (env_size_t j = 0; j < lh; ++j)
+  {
+    if (sptr != expanded)
+    {
+      const intg16* s = sptr; env_size_t ci = 0;
+      for (env_size_t i = 0; i < lw; ++i)
+      {
+        srow[i] = *s;
+        if ((++ci) == scalex && i != remx) { ci = 0; ++s; }
+      }
+      expanded = sptr;
+    }
+
+    env_size_t i = 0;
+#ifdef ENV_SIMD16_WIDTH
+    for ( ; i + ENV_SIMD16_WIDTH <= lw; i += ENV_SIMD16_WIDTH)
+    {
+      const env_vec16 l = env_vec16_load(lptr + i), s = env_vec16_load(srow + i);
+      const env_vec16 d = env_vec16_sub(l, s);
+      env_vec16_store_widen(dptr + i, env_vec16_max(d, absol ? env_vec16_sub(s, l) : env_vec16_zero()), (int)shift);
+    }
+#endif
+    for ( ; i < lw; ++i)
+    {
+      const intg32 d = lptr[i] - srow[i];
+      dptr[i] = (d > 0 ? d : (absol ? -d : 0)) << shift;
+    }
+
+    lptr += lw; dptr += lw; sptr += rowstep;
+    if ((++cj) == scaley && j != remy) cj = 0; else sptr -= sw;
+  }
+
+  env_deallocate(srow);
+
+  // attenuate borders:
+  env_attenuate_borders_inplace(result, ENV_MAX(result->dims.w, result->dims.h) / 20);
+}
@@ -0,0 +1,88 @@
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// JeVois Smart Embedded Machine Vision Toolkit - Copyright (C) 2016 by Laurent Itti, the University of Southern
+// California (USC), and iLab at USC. See http://iLab.usc.edu and http://jevois.org for information about this project.
+//
+// This file is part of the JeVois Smart Embedded Machine Vision Toolkit.  This program is free software; you can
+// redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software
+// Foundation, version 2.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.  You should have received a copy of the GNU General Public License along with this program;
+// if not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// Contact information: Laurent Itti - 3641 Watt Way, HNB-07A - Los Angeles, CA 90089-2520 - USA.
+// Tel: +1 213 740 3527 - itti@pollux.usc.edu - http://iLab.usc.edu - http://jevois.org
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \file */
+
+#pragma once
+
+#include <jevoisbase/src/Components/Saliency/env_image.h>
+#include <jevoisbase/src/Components/Saliency/env_math.h>
+#include <jevoisbase/src/Components/Saliency/env_pyr.h>
+
+//! Number of magnitude bits of values stored in 16-bit fixed-point images
+/*! Values are right-shifted by (imath->nbits - ENV_FIXED16_BITS) when converted from intg32, and then saturated to
+    [-ENV_FIXED16_MAX, ENV_FIXED16_MAX]. This leaves enough headroom for opponent color values (which can exceed
+    1<<nbits) and guarantees that the sums computed by the 5-tap lowpass and center-surround never overflow 16 bits. */
+#define ENV_FIXED16_BITS 12
+
+//! Saturation bound of values stored in 16-bit fixed-point images
+#define ENV_FIXED16_MAX 8191
+
+//! Basic 16-bit fixed-point image class
+struct env_image16
+{
+    struct env_dims dims;   // width+height of data array
+    intg16* pixels;         // data array
+};
+
+//! A dyadic pyramid of 16-bit fixed-point images
+/*! Pixel values are those of the equivalent intg32 pyramid, right-shifted by shift bits. */
+struct env_pyr16
+{
+    struct env_image16* images;
+    env_size_t depth;
+    env_size_t shift;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  //! Number of bits by which intg32 values are right-shifted when stored into 16-bit fixed-point images
+  static inline env_size_t env_fixed16_shift(const struct env_math* imath)
+  { return imath->nbits > ENV_FIXED16_BITS ? imath->nbits - ENV_FIXED16_BITS : 0; }
+
+  //! Resize an image, memory contents are undefined after this
+  void env_img16_resize_dims(struct env_image16* img, const struct env_dims d);
+
+  //! Free the memory of an image
+  void env_img16_make_empty(struct env_image16* img);
+
+  //! Convert an intg32 image to 16-bit fixed-point, with right shift and saturation
+  void env_img16_pack(const struct env_image* src, const env_size_t shift, struct env_image16* dst);
+
+  //! Construct with a given number of empty images
+  void env_pyr16_init(struct env_pyr16* pyr, const env_size_t depth, const env_size_t shift);
+
+  //! Free all images of a pyramid
+  void env_pyr16_make_empty(struct env_pyr16* pyr);
+
+  //! Build a lowpass-5 pyramid with 16-bit fixed-point arithmetic
+  /*! image is taken as level imglev of the pyramid; it is converted to 16-bit fixed-point and all higher levels are
+      then computed using the same filters as env_pyr_build_lowpass_5(), but operating on 16-bit values. Levels below
+      firstlevel are left empty. */
+  void env_pyr16_build_lowpass_5(const struct env_image* image, const env_size_t imglev, const env_size_t firstlevel,
+                                 struct env_pyr16* result);
+
+  //! Center-surround difference of two 16-bit fixed-point images, into an intg32 result
+  /*! Same as env_center_surround() but with 16-bit inputs; the difference is shifted back left by shift bits when
+      stored into result, which hence has the same scale as the output of env_center_surround(). */
+  void env_center_surround16(const struct env_image16* center, const struct env_image16* surround,
+                             const int absol, const env_size_t shift, struct env_image* result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,252 @@
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// JeVois Smart Embedded Machine Vision Toolkit - Copyright (C) 2016 by Laurent Itti, the University of Southern
+// California (USC), and iLab at USC. See http://iLab.usc.edu and http://jevois.org for information about this project.
+//
+// This file is part of the JeVois Smart Embedded Machine Vision Toolkit.  This program is free software; you can
+// redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software
+// Foundation, version 2.  This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+// without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+// License for more details.  You should have received a copy of the GNU General Public License along with this program;
+// if not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// Contact information: Laurent Itti - 3641 Watt Way, HNB-07A - Los Angeles, CA 90089-2520 - USA.
+// Tel: +1 213 740 3527 - itti@pollux.usc.edu - http://iLab.usc.edu - http://jevois.org
+// ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/*! \file */
+
+#pragma once
+
+#include <jevoisbase/src/Components/Saliency/env_types.h>
+
+// Minimal set of integer vector operations used by the envision kernels. The instruction set is selected at compile
+// time: NEON on the ARM platform, and AVX2 or SSE4.1 on the host depending on the compiler flags. When none of these
+// is available, ENV_SIMD_WIDTH is left undefined and only the plain C code paths are compiled. All operations are on
+// vectors of ENV_SIMD_WIDTH signed 32-bit ints, with the same wraparound semantics as the scalar code, so that results
+// are bit-exact whether or not SIMD is used. A second set of operations works on vectors of ENV_SIMD16_WIDTH signed
+// 16-bit ints, for the fixed-point 16-bit pyramids (see env_pyr16.h). Define ENV_SIMD_DISABLE to force the plain C
+// code paths, e.g., to compare them against the SIMD ones in jevoisbase-simdtest.
+
+#if defined(ENV_SIMD_DISABLE)
+
+// No SIMD, ENV_SIMD_WIDTH and ENV_SIMD16_WIDTH stay undefined
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+#define ENV_SIMD_WIDTH 4
+
+typedef int32x4_t env_vec;
+
+static inline env_vec env_vec_load(const intg32* p) { return vld1q_s32(p); }
+static inline void env_vec_store(intg32* p, const env_vec v) { vst1q_s32(p, v); }
+static inline env_vec env_vec_set1(const intg32 x) { return vdupq_n_s32(x); }
+static inline env_vec env_vec_add(const env_vec a, const env_vec b) { return vaddq_s32(a, b); }
+static inline env_vec env_vec_sub(const env_vec a, const env_vec b) { return vsubq_s32(a, b); }
+static inline env_vec env_vec_mul(const env_vec a, const intg32 k) { return vmulq_n_s32(a, k); }
+static inline env_vec env_vec_min(const env_vec a, const env_vec b) { return vminq_s32(a, b); }
+static inline env_vec env_vec_max(const env_vec a, const env_vec b) { return vmaxq_s32(a, b); }
+#define env_vec_srai(a, n) vshrq_n_s32((a), (n))
+static inline env_vec env_vec_sra(const env_vec a, const int n) { return vshlq_s32(a, vdupq_n_s32(-n)); }
+static inline env_vec env_vec_cmpeq(const env_vec a, const env_vec b) { return vreinterpretq_s32_u32(vceqq_s32(a, b)); }
+static inline env_vec env_vec_and(const env_vec a, const env_vec b) { return vandq_s32(a, b); }
+
+//! Load 2*ENV_SIMD_WIDTH values and split them into even and odd elements
+static inline void env_vec_load_deinterleave(const intg32* p, env_vec* even, env_vec* odd)
+{ const int32x4x2_t v = vld2q_s32(p); *even = v.val[0]; *odd = v.val[1]; }
+
+#define ENV_SIMD16_WIDTH 8
+
+typedef int16x8_t env_vec16;
+
+static inline env_vec16 env_vec16_load(const intg16* p) { return vld1q_s16(p); }
+static inline void env_vec16_store(intg16* p, const env_vec16 v) { vst1q_s16(p, v); }
+static inline env_vec16 env_vec16_zero(void) { return vdupq_n_s16(0); }
+static inline env_vec16 env_vec16_add(const env_vec16 a, const env_vec16 b) { return vaddq_s16(a, b); }
+static inline env_vec16 env_vec16_sub(const env_vec16 a, const env_vec16 b) { return vsubq_s16(a, b); }
+static inline env_vec16 env_vec16_set1(const intg16 x) { return vdupq_n_s16(x); }
+static inline env_vec16 env_vec16_max(const env_vec16 a, const env_vec16 b) { return vmaxq_s16(a, b); }
+static inline env_vec16 env_vec16_min(const env_vec16 a, const env_vec16 b) { return vminq_s16(a, b); }
+#define env_vec16_srai(a, n) vshrq_n_s16((a), (n))
+
+//! Load 2*ENV_SIMD16_WIDTH values and split them into even and odd elements
+static inline void env_vec16_load_deinterleave(const intg16* p, env_vec16* even, env_vec16* odd)
+{ const int16x8x2_t v = vld2q_s16(p); *even = v.val[0]; *odd = v.val[1]; }
+
+//! Load ENV_SIMD16_WIDTH 32-bit values, shift them right by n bits, and narrow them to 16 bits with saturation
+static inline env_vec16 env_vec16_load_narrow(const intg32* p, const int n)
+{
+  const int32x4_t sh = vdupq_n_s32(-n);
+  return vcombine_s16(vqmovn_s32(vshlq_s32(vld1q_s32(p), sh)), vqmovn_s32(vshlq_s32(vld1q_s32(p + 4), sh)));
+}
+
+//! Sign-extend to 32 bits, shift left by n bits, and store ENV_SIMD16_WIDTH values
+static inline void env_vec16_store_widen(intg32* p, const env_vec16 v, const int n)
+{
+  const int32x4_t sh = vdupq_n_s32(n);
+  vst1q_s32(p, vshlq_s32(vmovl_s16(vget_low_s16(v)), sh));
+  vst1q_s32(p + 4, vshlq_s32(vmovl_s16(vget_high_s16(v)), sh));
+}
+
+#elif defined(__AVX2__)
+
+#include <immintrin.h>
+
+#define ENV_SIMD_WIDTH 8
+
+typedef __m256i env_vec;
+
+static inline env_vec env_vec_load(const intg32* p) { return _mm256_loadu_si256((const __m256i*)p); }
+static inline void env_vec_store(intg32* p, const env_vec v) { _mm256_storeu_si256((__m256i*)p, v); }
+static inline env_vec env_vec_set1(const intg32 x) { return _mm256_set1_epi32(x); }
+static inline env_vec env_vec_add(const env_vec a, const env_vec b) { return _mm256_add_epi32(a, b); }
+static inline env_vec env_vec_sub(const env_vec a, const env_vec b) { return _mm256_sub_epi32(a, b); }
+static inline env_vec env_vec_mul(const env_vec a, const intg32 k)
+{ return _mm256_mullo_epi32(a, _mm256_set1_epi32(k)); }
+static inline env_vec env_vec_min(const env_vec a, const env_vec b) { return _mm256_min_epi32(a, b); }
+static inline env_vec env_vec_max(const env_vec a, const env_vec b) { return _mm256_max_epi32(a, b); }
+#define env_vec_srai(a, n) _mm256_srai_epi32((a), (n))
+static inline env_vec env_vec_sra(const env_vec a, const int n) { return _mm256_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline env_vec env_vec_cmpeq(const env_vec a, const env_vec b) { return _mm256_cmpeq_epi32(a, b); }
+static inline env_vec env_vec_and(const env_vec a, const env_vec b) { return _mm256_and_si256(a, b); }
+
+//! Load 2*ENV_SIMD_WIDTH values and split them into even and odd elements
+static inline void env_vec_load_deinterleave(const intg32* p, env_vec* even, env_vec* odd)
+{
+  const __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)p));
+  const __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(p + 8)));
+  // shuffle_ps works within 128-bit lanes, so we then need to re-order the 64-bit quarters:
+  *even = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+                                   _MM_SHUFFLE(3, 1, 2, 0));
+  *odd = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))),
+                                  _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+#define ENV_SIMD16_WIDTH 16
+
+typedef __m256i env_vec16;
+
+static inline env_vec16 env_vec16_load(const intg16* p) { return _mm256_loadu_si256((const __m256i*)p); }
+static inline void env_vec16_store(intg16* p, const env_vec16 v) { _mm256_storeu_si256((__m256i*)p, v); }
+static inline env_vec16 env_vec16_zero(void) { return _mm256_setzero_si256(); }
+static inline env_vec16 env_vec16_add(const env_vec16 a, const env_vec16 b) { return _mm256_add_epi16(a, b); }
+static inline env_vec16 env_vec16_sub(const env_vec16 a, const env_vec16 b) { return _mm256_sub_epi16(a, b); }
+static inline env_vec16 env_vec16_set1(const intg16 x) { return _mm256_set1_epi16(x); }
+static inline env_vec16 env_vec16_max(const env_vec16 a, const env_vec16 b) { return _mm256_max_epi16(a, b); }
+static inline env_vec16 env_vec16_min(const env_vec16 a, const env_vec16 b) { return _mm256_min_epi16(a, b); }
+#define env_vec16_srai(a, n) _mm256_srai_epi16((a), (n))
+
+//! Load 2*ENV_SIMD16_WIDTH values and split them into even and odd elements
+static inline void env_vec16_load_deinterleave(const intg16* p, env_vec16* even, env_vec16* odd)
+{
+  const __m256i a = _mm256_loadu_si256((const __m256i*)p);
+  const __m256i b = _mm256_loadu_si256((const __m256i*)(p + 16));
+  // sign-extend even and odd elements to 32 bits, then pack back; packs works within 128-bit lanes so we then need to
+  // re-order the 64-bit quarters:
+  const __m256i ae = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+  const __m256i be = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+  *even = _mm256_permute4x64_epi64(_mm256_packs_epi32(ae, be), _MM_SHUFFLE(3, 1, 2, 0));
+  *odd = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_srai_epi32(a, 16), _mm256_srai_epi32(b, 16)),
+                                  _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+//! Load ENV_SIMD16_WIDTH 32-bit values, shift them right by n bits, and narrow them to 16 bits with saturation
+static inline env_vec16 env_vec16_load_narrow(const intg32* p, const int n)
+{
+  const __m128i sh = _mm_cvtsi32_si128(n);
+  const __m256i a = _mm256_sra_epi32(_mm256_loadu_si256((const __m256i*)p), sh);
+  const __m256i b = _mm256_sra_epi32(_mm256_loadu_si256((const __m256i*)(p + 8)), sh);
+  return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+//! Sign-extend to 32 bits, shift left by n bits, and store ENV_SIMD16_WIDTH values
+static inline void env_vec16_store_widen(intg32* p, const env_vec16 v, const int n)
+{
+  const __m128i sh = _mm_cvtsi32_si128(n);
+  _mm256_storeu_si256((__m256i*)p, _mm256_sll_epi32(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)), sh));
+  _mm256_storeu_si256((__m256i*)(p + 8), _mm256_sll_epi32(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)), sh));
+}
+
+#elif defined(__SSE4_1__)
+
+#include <smmintrin.h>
+
+#define ENV_SIMD_WIDTH 4
+
+typedef __m128i env_vec;
+
+static inline env_vec env_vec_load(const intg32* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline void env_vec_store(intg32* p, const env_vec v) { _mm_storeu_si128((__m128i*)p, v); }
+static inline env_vec env_vec_set1(const intg32 x) { return _mm_set1_epi32(x); }
+static inline env_vec env_vec_add(const env_vec a, const env_vec b) { return _mm_add_epi32(a, b); }
+static inline env_vec env_vec_sub(const env_vec a, const env_vec b) { return _mm_sub_epi32(a, b); }
+static inline env_vec env_vec_mul(const env_vec a, const intg32 k) { return _mm_mullo_epi32(a, _mm_set1_epi32(k)); }
+static inline env_vec env_vec_min(const env_vec a, const env_vec b) { return _mm_min_epi32(a, b); }
+static inline env_vec env_vec_max(const env_vec a, const env_vec b) { return _mm_max_epi32(a, b); }
+#define env_vec_srai(a, n) _mm_srai_epi32((a), (n))
+static inline env_vec env_vec_sra(const env_vec a, const int n) { return _mm_sra_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline env_vec env_vec_cmpeq(const env_vec a, const env_vec b) { return _mm_cmpeq_epi32(a, b); }
+static inline env_vec env_vec_and(const env_vec a, const env_vec b) { return _mm_and_si128(a, b); }
+
+//! Load 2*ENV_SIMD_WIDTH values and split them into even and odd elements
+static inline void env_vec_load_deinterleave(const intg32* p, env_vec* even, env_vec* odd)
+{
+  const __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)p));
+  const __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(p + 4)));
+  *even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+  *odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+#define ENV_SIMD16_WIDTH 8
+
+typedef __m128i env_vec16;
+
+static inline env_vec16 env_vec16_load(const intg16* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline void env_vec16_store(intg16* p, const env_vec16 v) { _mm_storeu_si128((__m128i*)p, v); }
+static inline env_vec16 env_vec16_zero(void) { return _mm_setzero_si128(); }
+static inline env_vec16 env_vec16_add(const env_vec16 a, const env_vec16 b) { return _mm_add_epi16(a, b); }
+static inline env_vec16 env_vec16_sub(const env_vec16 a, const env_vec16 b) { return _mm_sub_epi16(a, b); }
+static inline env_vec16 env_vec16_set1(const intg16 x) { return _mm_set1_epi16(x); }
+static inline env_vec16 env_vec16_max(const env_vec16 a, const env_vec16 b) { return _mm_max_epi16(a, b); }
+static inline env_vec16 env_vec16_min(const env_vec16 a, const env_vec16 b) { return _mm_min_epi16(a, b); }
+#define env_vec16_srai(a, n) _mm_srai_epi16((a), (n))
+
+//! Load 2*ENV_SIMD16_WIDTH values and split them into even and odd elements
+static inline void env_vec16_load_deinterleave(const intg16* p, env_vec16* even, env_vec16* odd)
+{
+  const __m128i a = _mm_loadu_si128((const __m128i*)p);
+  const __m128i b = _mm_loadu_si128((const __m128i*)(p + 8));
+  // sign-extend even and odd elements to 32 bits, then pack back:
+  *even = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+  *odd = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+}
+
+//! Load ENV_SIMD16_WIDTH 32-bit values, shift them right by n bits, and narrow them to 16 bits with saturation
+static inline env_vec16 env_vec16_load_narrow(const intg32* p, const int n)
+{
+  const __m128i sh = _mm_cvtsi32_si128(n);
+  return _mm_packs_epi32(_mm_sra_epi32(_mm_loadu_si128((const __m128i*)p), sh),
+                         _mm_sra_epi32(_mm_loadu_si128((const __m128i*)(p + 4)), sh));
+}
+
+//! Sign-extend to 32 bits, shift left by n bits, and store ENV_SIMD16_WIDTH values
+static inline void env_vec16_store_widen(intg32* p, const env_vec16 v, const int n)
+{
+  const __m128i sh = _mm_cvtsi32_si128(n);
+  _mm_storeu_si128((__m128i*)p, _mm_sll_epi32(_mm_cvtepi16_epi32(v), sh));
+  _mm_storeu_si128((__m128i*)(p + 4), _mm_sll_epi32(_mm_cvtepi16_epi32(_mm_srli_si128(v, 8)), sh));
+}
+
+#endif
+
+#ifdef ENV_SIMD_WIDTH
+//! Sum of all elements of a vector
+static inline intg32 env_vec_hsum(const env_vec v)
+{
+  intg32 tmp[ENV_SIMD_WIDTH]; env_vec_store(tmp, v);
+  intg32 sum = 0;
+  for (int k = 0; k < ENV_SIMD_WIDTH; ++k) sum += tmp[k];
+  return sum;
+}
+#endif